@@ -611,7 +611,8 @@ class clusterer:
                  batch_sample_sizes: Union[np.ndarray, None] = None,
                  device_id: int = 0,
                  verbose: bool = False,
-                 dimensions: Union[list, None] = None) -> None:
+                 dimensions: Union[list, None] = None,
+                 n_jobs: Union[int, None] = None) -> None:
         """
         Execute the CLUE clustering algorithm.
 
@@ -625,9 +626,14 @@ class clusterer:
         :type verbose: bool, optional
         :param dimensions: Optional list of dimensions to consider. Defaults to None.
         :type dimensions: list[int] or None, optional
+        :param n_jobs: Maximum number of threads used by the CPU backends. If None, the default
+                       of the backend is used. Defaults to None.
+        :type n_jobs: int or None, optional
 
         :returns: None
         """
+        if n_jobs is not None and n_jobs < 1:
+            raise ValueError("The number of jobs must be a positive integer.")
         if dimensions is None:
             data = self.clust_data
         else:
@@ -640,7 +646,7 @@ class clusterer:
         arguments = [self._density_radius, self._min_density, self._outlier_distance, self._seeding_distance,
                      self.wrapped, data.coords, data.results,
                      self._kernel, data.n_dim, batch_sample_sizes, data.n_points,
-                     device_id, self._metric]
+                     device_id, self._metric, 0 if n_jobs is None else n_jobs]
         start = time.time_ns()
         if backend == "cpu serial":
             cluster_id_is_seed = cpu_serial.mainRun(*arguments)
@@ -695,7 +701,8 @@ class clusterer:
             batch_sample_sizes: Union[np.ndarray, None] = None,
             device_id: int = 0,
             verbose: bool = False,
-            dimensions: Union[list, None] = None) -> 'Clusterer':
+            dimensions: Union[list, None] = None,
+            n_jobs: Union[int, None] = None) -> 'Clusterer':
         """
         Run the CLUE clustering algorithm on the input data.
 
@@ -713,6 +720,9 @@ class clusterer:
         :type verbose: bool, optional
         :param dimensions: List of dimensions to consider. If None, all are used.
         :type dimensions: list or None, optional
+        :param n_jobs: Maximum number of threads used by the CPU backends. If None, the default
+                       of the backend is used.
+        :type n_jobs: int or None, optional
 
         :return: Returns the clusterer object itself.
         :rtype: Clusterer
@@ -721,7 +731,7 @@ class clusterer:
         """
 
         self.read_data(data)
-        self.run_clue(backend, batch_sample_sizes, device_id, verbose, dimensions)
+        self.run_clue(backend, batch_sample_sizes, device_id, verbose, dimensions, n_jobs)
         return self
 
     def fit_predict(self,
@@ -730,7 +740,8 @@ class clusterer:
                     batch_sample_sizes: Union[np.ndarray, None] = None,
                     device_id: int = 0,
                     verbose: bool = False,
-                    dimensions: Union[list, None] = None) -> np.ndarray:
+                    dimensions: Union[list, None] = None,
+                    n_jobs: Union[int, None] = None) -> np.ndarray:
         """
         Run the CLUE clustering algorithm and return the cluster labels.
 
@@ -748,6 +759,9 @@ class clusterer:
         :type verbose: bool, optional
         :param dimensions: List of dimensions to consider. If None, all are used.
         :type dimensions: list or None, optional
+        :param n_jobs: Maximum number of threads used by the CPU backends. If None, the default
+                       of the backend is used.
+        :type n_jobs: int or None, optional
 
         :return: Array containing the cluster index for every point.
         :rtype: np.ndarray
@@ -756,7 +770,7 @@ class clusterer:
         """
 
         self.read_data(data)
-        self.run_clue(backend, batch_sample_sizes, device_id, verbose, dimensions)
+        self.run_clue(backend, batch_sample_sizes, device_id, verbose, dimensions, n_jobs)
         return self.cluster_ids
 
 
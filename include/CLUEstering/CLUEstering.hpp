@@ -5,8 +5,16 @@
 #pragma once
 
 #include "CLUEstering/core/Clusterer.hpp"
+#include "CLUEstering/core/ClustererPool.hpp"
 #include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/EventBatcher.hpp"
+#include "CLUEstering/core/EventScheduler.hpp"
+#include "CLUEstering/core/ExecutionResources.hpp"
+#include "CLUEstering/core/IncrementalClusterer.hpp"
+#include "CLUEstering/core/OutOfCoreClusterer.hpp"
+#include "CLUEstering/core/ShardedClusterer.hpp"
 #include "CLUEstering/core/detail/defines.hpp"
+#include "CLUEstering/data_structures/EventBatch.hpp"
 #include "CLUEstering/data_structures/PointsHost.hpp"
 #include "CLUEstering/data_structures/PointsDevice.hpp"
 #include "CLUEstering/data_structures/PointsConversion.hpp"
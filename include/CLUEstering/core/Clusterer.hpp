@@ -6,10 +6,13 @@
 
 #include "CLUEstering/core/DistanceMetrics.hpp"
 #include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/ExecutionResources.hpp"
 #include "CLUEstering/core/detail/ClusteringKernels.hpp"
+#include "CLUEstering/core/detail/NeighbourLists.hpp"
 #include "CLUEstering/core/detail/SetupTiles.hpp"
 #include "CLUEstering/core/detail/defines.hpp"
 #include "CLUEstering/data_structures/AssociationMap.hpp"
+#include "CLUEstering/data_structures/EventBatch.hpp"
 #include "CLUEstering/data_structures/PointsHost.hpp"
 #include "CLUEstering/data_structures/PointsDevice.hpp"
 #include "CLUEstering/data_structures/PointsConversion.hpp"
@@ -17,12 +20,14 @@
 #include "CLUEstering/data_structures/internal/SeedArray.hpp"
 #include "CLUEstering/data_structures/internal/Tiles.hpp"
 
+#include <algorithm>
 #include <array>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <span>
+#include <stdexcept>
 #include <type_traits>
 
 namespace clue {
@@ -45,16 +50,67 @@ namespace clue {
     value_type m_min_density;
     value_type m_outlier_distance;
     std::array<uint8_t, Ndim> m_wrappedCoordinates;
+    bool m_sortedTiles;
+    bool m_separateNearestHigherTiles;
+    bool m_pairwiseDensity;
+    std::size_t m_bruteForceThreshold;
+    bool m_blockPerEvent;
+    ExecutionResources m_executionResources;
+    // whether the tiles hold the points of the last run, so that they can be updated in place
+    bool m_filledTiles;
+    // the coordinates of the points of the last run, to tell them apart from other buffers of the
+    // same size when reusing the tiles or the neighbour lists
+    const void* m_clusteredCoords;
+    bool m_neighbourLists;
+    std::size_t m_neighbourListsMaxBytes;
+
+    std::optional<detail::NeighbourLists<clue::Device, value_type>> m_neighbours;
 
     std::optional<internal::Tiles<Ndim, value_type, clue::Device>> m_tiles;
+    std::optional<internal::Tiles<Ndim, value_type, clue::Device>> m_nearest_higher_tiles;
     std::optional<internal::SeedArray<>> m_seeds;
+    std::optional<clue::device_buffer<clue::Device, int32_t[]>> m_seedPositions;
     std::optional<internal::DeviceVector<>> m_event_associations;
+    std::optional<detail::PartialDensities<clue::Device, value_type>> m_partialDensities;
+
+    template <std::floating_point InputType>
+    void sort_tiles(Queue& queue,
+                    internal::Tiles<Ndim, value_type, clue::Device>& tiles,
+                    clue::PointsDevice<Ndim, InputType>& dev_points) {
+      tiles.view().sorted = m_sortedTiles;
+      if (m_sortedTiles) {
+        detail::sortTiles<internal::Acc>(
+            queue, 256, tiles.view(), dev_points.view(), tiles.extents().keys);
+      }
+    }
+
+    template <typename TPoints>
+    void setup_nearest_higher_tiles(Queue& queue, const TPoints& points, std::size_t batch_size = 1) {
+      if (m_separateNearestHigherTiles) {
+        detail::setup_tiles_for_radius(queue,
+                                       points,
+                                       m_nearest_higher_tiles,
+                                       m_outlier_distance,
+                                       m_tiles->nPerDim(),
+                                       m_wrappedCoordinates,
+                                       batch_size);
+      }
+    }
+
+    bool use_brute_force(std::size_t n_points) const { return n_points < m_bruteForceThreshold; }
+
+    // Batches whose events all fit in the shared memory of a block are clustered one event per block
+    template <std::floating_point InputType>
+    bool use_block_per_event(std::span<const uint32_t> batch_item_sizes) const;
 
     template <std::floating_point InputType>
     void setup(Queue& queue,
                const clue::PointsHost<Ndim, InputType>& h_points,
                clue::PointsDevice<Ndim, value_type>& dev_points) {
-      detail::setup_tiles(queue, h_points, m_tiles, 128, m_wrappedCoordinates);
+      if (!use_brute_force(h_points.size())) {
+        detail::setup_tiles(queue, h_points, m_tiles, 128, m_wrappedCoordinates);
+        setup_nearest_higher_tiles(queue, h_points);
+      }
       clue::copyToDevice(queue, dev_points, h_points);
     }
 
@@ -62,16 +118,39 @@ namespace clue {
     void setup_batch(Queue& queue,
                      const clue::PointsHost<Ndim, InputType>& h_points,
                      clue::PointsDevice<Ndim, value_type>& dev_points,
-                     std::size_t batch_size) {
-      detail::setup_tiles(queue, h_points, m_tiles, 128, m_wrappedCoordinates, batch_size);
+                     std::size_t batch_size,
+                     bool block_per_event) {
+      if (!block_per_event) {
+        detail::setup_tiles(queue, h_points, m_tiles, 128, m_wrappedCoordinates, batch_size);
+        setup_nearest_higher_tiles(queue, h_points, batch_size);
+      }
       clue::copyToDevice(queue, dev_points, h_points);
     }
 
     template <std::floating_point InputType>
     void setup_batch(Queue& queue,
                      clue::PointsDevice<Ndim, InputType>& dev_points,
-                     std::size_t batch_size) {
-      detail::setup_tiles(queue, dev_points, m_tiles, 128, m_wrappedCoordinates, batch_size);
+                     std::size_t batch_size,
+                     bool block_per_event) {
+      if (!block_per_event) {
+        const auto n_per_dim = detail::tiles_per_dim<Ndim>(dev_points.size(), 128);
+        detail::setup_batch_tiles<internal::Acc>(queue,
+                                                 dev_points,
+                                                 m_tiles,
+                                                 n_per_dim,
+                                                 m_wrappedCoordinates,
+                                                 batch_size);
+        // the batched clustering keeps the tiles of the nearest-higher search from being smaller
+        // than the outlier distance, so they can start from the same grid as the default tiles
+        if (m_separateNearestHigherTiles) {
+          detail::setup_batch_tiles<internal::Acc>(queue,
+                                                   dev_points,
+                                                   m_nearest_higher_tiles,
+                                                   n_per_dim,
+                                                   m_wrappedCoordinates,
+                                                   batch_size);
+        }
+      }
     }
 
     template <
@@ -81,16 +160,58 @@ namespace clue {
     void make_clusters_impl(clue::PointsDevice<Ndim, InputType>& dev_points,
                             const DistanceMetric& metric,
                             const Kernel& kernel,
-                            Queue& queue);
+                            Queue& queue,
+                            bool warm_start = false);
+    // Rebins the points of the last run that moved to a different tile, returning the number of
+    // points rebinned, or nothing if the grids of the tiles cannot hold the points anymore
+    template <std::floating_point InputType>
+    std::optional<std::size_t> update_tiles(Queue& queue,
+                                            clue::PointsDevice<Ndim, InputType>& dev_points);
+    // Builds the neighbour lists of the points from the filled tiles, returning whether they fit
+    // in the memory allowed for them
+    template <std::floating_point InputType, concepts::distance_metric<Ndim> DistanceMetric>
+    bool build_neighbour_lists(Queue& queue,
+                               clue::PointsDevice<Ndim, InputType>& dev_points,
+                               const DistanceMetric& metric);
+    // Checks whether the neighbour lists hold the points of the last run within the current
+    // clustering distances
+    template <std::floating_point InputType>
+    bool reusable_neighbour_lists(const clue::PointsDevice<Ndim, InputType>& dev_points) const;
+    // Runs the density and nearest-higher passes over the neighbour lists
+    template <std::floating_point InputType, concepts::convolutional_kernel Kernel>
+    void make_clusters_from_neighbours(clue::PointsDevice<Ndim, InputType>& dev_points,
+                                       const Kernel& kernel,
+                                       Queue& queue);
     template <
         std::floating_point InputType,
         concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
         concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
-    void make_clusters_batched(clue::PointsDevice<Ndim, InputType>& dev_points,
-                               std::span<const uint32_t> batch_item_sizes,
-                               const DistanceMetric& metric,
-                               const Kernel& kernel,
-                               Queue& queue);
+    void make_clusters_batched(
+        clue::PointsDevice<Ndim, InputType>& dev_points,
+        const clue::device_buffer<clue::Device, std::size_t[]>& event_offsets,
+        bool block_per_event,
+        const EventParameters<value_type>* event_parameters,
+        const DistanceMetric& metric,
+        const Kernel& kernel,
+        Queue& queue);
+
+    // Copies the per-event parameters to the device, checking that there is one for each event
+    auto make_event_parameters(Queue& queue,
+                               std::span<const EventParameters<value_type>> event_parameters,
+                               std::size_t batch_size) const {
+      if (event_parameters.size() != batch_size) {
+        throw std::invalid_argument(
+            "The number of event parameters must match the number of events in the batch");
+      }
+      auto h_event_parameters =
+          clue::make_host_buffer<EventParameters<value_type>[]>(queue, batch_size);
+      std::ranges::copy(event_parameters, h_event_parameters.data());
+      auto d_event_parameters =
+          clue::make_device_buffer<EventParameters<value_type>[]>(queue, batch_size);
+      alpaka::memcpy(queue, d_event_parameters, h_event_parameters);
+      alpaka::wait(queue);
+      return d_event_parameters;
+    }
 
   public:
     /// @brief Constuct a Clusterer object
@@ -253,9 +374,328 @@ namespace clue {
                        const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
                        const Kernel& kernel = FlatKernel<value_type>{.5f});
 
+    /// @brief Construct the clusters from batched device points, whose event sizes reside on the
+    /// device
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param dev_points Device points to cluster
+    /// @param event_sizes Sizes of each batch item, stored on the device
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note The offsets of the events are computed on the device, so the sizes are never copied
+    /// to the host. Since the sizes are not known on the host, the events are always clustered
+    /// with the tiled algorithm.
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    void make_clusters(Queue& queue,
+                       clue::PointsDevice<Ndim, InputType>& dev_points,
+                       DeviceEventSizes event_sizes,
+                       const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                       const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Construct the clusters from batched device points, whose event offsets reside on the
+    /// device
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param dev_points Device points to cluster
+    /// @param event_offsets Offsets of each batch item, stored on the device
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note Since the sizes of the events are not known on the host, the events are always
+    /// clustered with the tiled algorithm.
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    void make_clusters(Queue& queue,
+                       clue::PointsDevice<Ndim, InputType>& dev_points,
+                       DeviceEventOffsets event_offsets,
+                       const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                       const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Construct the clusters from batched host and device points, with different
+    /// clustering parameters for each event
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param h_points Host points to cluster
+    /// @param dev_points Device points to cluster
+    /// @param batch_item_sizes Sizes of each batch item
+    /// @param event_parameters Clustering parameters of each batch item
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note The parameters of the clusterer are not used, except for building the tiles
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    void make_clusters(Queue& queue,
+                       clue::PointsHost<Ndim, InputType>& h_points,
+                       clue::PointsDevice<Ndim, value_type>& dev_points,
+                       std::span<const uint32_t> batch_item_sizes,
+                       std::span<const EventParameters<value_type>> event_parameters,
+                       const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                       const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Construct the clusters from batched device points, with different clustering
+    /// parameters for each event
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param dev_points Device points to cluster
+    /// @param batch_item_sizes Sizes of each batch item
+    /// @param event_parameters Clustering parameters of each batch item
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note The parameters of the clusterer are not used, except for building the tiles
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    void make_clusters(Queue& queue,
+                       clue::PointsDevice<Ndim, InputType>& dev_points,
+                       std::span<const uint32_t> batch_item_sizes,
+                       std::span<const EventParameters<value_type>> event_parameters,
+                       const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                       const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Construct the clusters from batched device points, whose event sizes and
+    /// clustering parameters reside on the device
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param dev_points Device points to cluster
+    /// @param event_sizes Sizes of each batch item, stored on the device
+    /// @param event_parameters Clustering parameters of each batch item, stored on the device
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note The parameters of the clusterer are not used, except for building the tiles
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    void make_clusters(Queue& queue,
+                       clue::PointsDevice<Ndim, InputType>& dev_points,
+                       DeviceEventSizes event_sizes,
+                       DeviceEventParameters<value_type> event_parameters,
+                       const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                       const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Construct the clusters from batched device points, whose event offsets and
+    /// clustering parameters reside on the device
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param dev_points Device points to cluster
+    /// @param event_offsets Offsets of each batch item, stored on the device
+    /// @param event_parameters Clustering parameters of each batch item, stored on the device
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note The parameters of the clusterer are not used, except for building the tiles
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    void make_clusters(Queue& queue,
+                       clue::PointsDevice<Ndim, InputType>& dev_points,
+                       DeviceEventOffsets event_offsets,
+                       DeviceEventParameters<value_type> event_parameters,
+                       const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                       const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Construct again the clusters of the points of the last run, after they moved
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param h_points Host points to cluster, with the new coordinates
+    /// @param dev_points Device points clustered in the last run
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @return The number of points moved to a different tile, equal to the number of points if
+    /// the tiles had to be rebuilt
+    /// @note When the points still fit in the tiles of the last run, only the points that moved
+    /// to a different tile are rebinned, and the nearest-higher of each point in the last run, if
+    /// still valid, bounds the search of its new nearest-higher. Otherwise the points are
+    /// clustered from scratch.
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    std::size_t update_positions(
+        Queue& queue,
+        clue::PointsHost<Ndim, InputType>& h_points,
+        clue::PointsDevice<Ndim, value_type>& dev_points,
+        const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+        const Kernel& kernel = FlatKernel<value_type>{.5f});
+    /// @brief Construct again the clusters of the device points of the last run, after they moved
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param dev_points Device points clustered in the last run, with the new coordinates
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @return The number of points moved to a different tile, equal to the number of points if
+    /// the tiles had to be rebuilt
+    /// @note When the points still fit in the tiles of the last run, only the points that moved
+    /// to a different tile are rebinned, and the nearest-higher of each point in the last run, if
+    /// still valid, bounds the search of its new nearest-higher. Otherwise the points are
+    /// clustered from scratch.
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    std::size_t update_positions(
+        Queue& queue,
+        clue::PointsDevice<Ndim, InputType>& dev_points,
+        const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+        const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Construct again the clusters of the points of the last run, with the current
+    /// clustering parameters
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param h_points Host points clustered in the last run
+    /// @param dev_points Device points clustered in the last run
+    /// @param metric The distance metric used in the last run, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @return True if the neighbour lists of the last run were reused
+    /// @note The neighbour lists are reused when they were built in the last run on the same
+    /// points and the clustering distances don't exceed the ones of that run, so that a sweep
+    /// over the parameters only scans the lists. Otherwise the points are clustered from scratch.
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    bool recluster(Queue& queue,
+                   clue::PointsHost<Ndim, InputType>& h_points,
+                   clue::PointsDevice<Ndim, value_type>& dev_points,
+                   const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                   const Kernel& kernel = FlatKernel<value_type>{.5f});
+    /// @brief Construct again the clusters of the device points of the last run, with the current
+    /// clustering parameters
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param dev_points Device points clustered in the last run
+    /// @param metric The distance metric used in the last run, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @return True if the neighbour lists of the last run were reused
+    /// @note The neighbour lists are reused when they were built in the last run on the same
+    /// points and the clustering distances don't exceed the ones of that run, so that a sweep
+    /// over the parameters only scans the lists. Otherwise the points are clustered from scratch.
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    bool recluster(Queue& queue,
+                   clue::PointsDevice<Ndim, InputType>& dev_points,
+                   const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                   const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Assign new points to the clusters found in the last run, without clustering again
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param reference Device points clustered in the last run
+    /// @param h_points Host points to assign to the clusters of the reference points
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note The density of each new point is computed against the reference points, and the
+    /// point takes the cluster of its nearest-higher among them. The new points are not compared
+    /// with each other, so they never form new clusters, and the points without a nearest-higher
+    /// are left unassigned.
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+      requires concepts::detail::point_distance_metric<DistanceMetric, Ndim>
+    void assign(Queue& queue,
+                clue::PointsDevice<Ndim, value_type>& reference,
+                clue::PointsHost<Ndim, InputType>& h_points,
+                const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                const Kernel& kernel = FlatKernel<value_type>{.5f});
+    /// @brief Assign new device points to the clusters found in the last run, without clustering
+    /// again
+    ///
+    /// @tparam InputType The data type of the input points, which must be a floating-point type.
+    /// By default, it is set to `float`.
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param queue The queue to use for the device operations
+    /// @param reference Device points clustered in the last run
+    /// @param dev_points Device points to assign to the clusters of the reference points
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note The density of each new point is computed against the reference points, and the
+    /// point takes the cluster of its nearest-higher among them. The new points are not compared
+    /// with each other, so they never form new clusters, and the points without a nearest-higher
+    /// are left unassigned.
+    template <
+        std::floating_point InputType,
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+      requires concepts::detail::point_distance_metric<DistanceMetric, Ndim>
+    void assign(Queue& queue,
+                clue::PointsDevice<Ndim, InputType>& reference,
+                clue::PointsDevice<Ndim, InputType>& dev_points,
+                const DistanceMetric& metric = clue::EuclideanMetric<Ndim, value_type>{},
+                const Kernel& kernel = FlatKernel<value_type>{.5f});
+
     /// @brief Specify which coordinates are periodic
     ///
     /// @param wrappedCoordinates Array of wrapped coordinates, where 1 means periodic and 0 means non-periodic
+    /// @note The period of a coordinate is the range of the clustered points along it. The points
+    /// assigned to the clusters afterwards can lie outside of that range by less than a period.
     template <std::ranges::contiguous_range TRange>
       requires std::integral<std::ranges::range_value_t<TRange>>
     void setWrappedCoordinates(const TRange& wrapped_coordinates);
@@ -263,9 +703,72 @@ namespace clue {
     ///
     /// @tparam TArgs Types of the wrapped coordinates, should be convertible to uint8_t
     /// @param wrappedCoordinates Wrapped coordinates, where 1 means periodic and 0 means non-periodic
+    /// @note The period of a coordinate is the range of the clustered points along it. The points
+    /// assigned to the clusters afterwards can lie outside of that range by less than a period.
     template <std::integral... TArgs>
     void setWrappedCoordinates(TArgs... wrapped_coordinates);
 
+    /// @brief Sort the points inside each tile by their first coordinate
+    ///
+    /// @param sorted_tiles If true, the points of each tile are sorted after filling the tiles,
+    /// so that the density and nearest-higher searches only scan the window of the tile which
+    /// is within the search distance along the first coordinate
+    /// @note The window is only used with the Euclidean, Manhattan and Chebyshev metrics on
+    /// non-periodic coordinates. It pays off when the tiles are much larger than the search radius.
+    void setSortedTiles(bool sorted_tiles);
+
+    /// @brief Use a separate, coarser grid of tiles for the nearest-higher search
+    ///
+    /// @param separate_tiles If true, the nearest-higher search runs on a second grid whose tiles
+    /// are sized on the outlier distance, while the density is computed on the default grid
+    /// @note This is useful when the outlier distance is several times larger than the density
+    /// radius, so that the search boxes of the nearest-higher search span a few large tiles instead
+    /// of many small ones. The second grid is never finer than the default one.
+    void setSeparateNearestHigherTiles(bool separate_tiles);
+
+    /// @brief Accumulate the density once per pair of points on the CPU backends
+    ///
+    /// @param pairwise_density If true, the contribution of each pair of neighbouring points is
+    /// computed once and added to both of them. By default it is false.
+    /// @note This is only done with the flat, Gaussian and exponential kernels, with the Euclidean,
+    /// Manhattan and Chebyshev metrics on non-periodic coordinates. The densities are summed in a
+    /// different order, so they can differ from the other backends in the last bits, and points
+    /// with equal densities can be clustered differently.
+    void setPairwiseDensity(bool pairwise_density);
+
+    /// @brief Set the size below which the points are clustered without tiles
+    ///
+    /// @param threshold Number of points below which density and nearest-highers are computed by
+    /// comparing all the pairs of points, skipping the construction of the tiles. By default it is
+    /// 0, so that the tiles are always used.
+    /// @note Batched clustering does not use this threshold.
+    void setBruteForceThreshold(std::size_t threshold);
+
+    /// @brief Cluster the batches of small events with one block per event
+    ///
+    /// @param block_per_event If true, the batches whose events all fit in the shared memory of a
+    /// block are clustered without tiles, one event per block. By default it is true.
+    /// @note Otherwise every batch is clustered with the tiled batched kernels.
+    void setBlockPerEvent(bool block_per_event);
+
+    /// @brief Store the neighbours of each point, which the nearest-higher search and the
+    /// following runs on the same points scan instead of the tiles
+    ///
+    /// @param neighbour_lists If true, the neighbours of each point within the largest of the
+    /// clustering distances are stored with their distances while computing the densities
+    /// @param max_bytes The maximum memory taken by the lists, above which the points are
+    /// clustered with the tiles. By default it is 256 MiB.
+    /// @note The lists are only used with the Euclidean, Manhattan and Chebyshev metrics. They are
+    /// reused by recluster, as long as the clustering distances don't exceed the ones with which
+    /// they were built.
+    void setNeighbourLists(bool neighbour_lists, std::size_t max_bytes = std::size_t{1} << 28);
+
+    /// @brief Set the execution resources used by the CPU backends
+    ///
+    /// @param resources The maximum number of threads and the cores to which they are pinned
+    /// @note This allows several clusterers to share a node without oversubscribing it
+    void setExecutionResources(ExecutionResources resources);
+
     /// @brief Get the list of seeds found in the last clustering run
     ///
     /// @return A span the the device array containing the seed indices
@@ -0,0 +1,163 @@
+/// @file ClustererPool.hpp
+/// @brief Provides the ClustererPool class, which clusters events concurrently on a set of workers
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/core/Clusterer.hpp"
+#include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/DistanceMetrics.hpp"
+#include "CLUEstering/core/detail/defines.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace clue {
+
+  /// @brief The ClustererPool class owns a set of workers, each with its own queue, Clusterer and
+  /// device points, and clusters the events submitted from any thread concurrently.
+  /// Each event is placed on the worker with the fewest points waiting to be clustered, so that
+  /// large events don't delay the small ones submitted after them.
+  ///
+  /// @tparam Ndim The number of dimensions of the points to cluster
+  /// @tparam TData The data type for the point coordinates and weights, which must be a
+  /// floating-point type. By default, it is set to `float`.
+  template <std::size_t Ndim, std::floating_point TData = float>
+  class ClustererPool {
+  public:
+    using value_type = std::remove_cv_t<TData>;
+
+    /// @brief Usage statistics of a worker of the pool
+    struct WorkerStatistics {
+      /// @brief The index of the device used by the worker
+      std::size_t device;
+      /// @brief The number of events clustered by the worker
+      std::size_t events;
+      /// @brief The number of points clustered by the worker
+      std::size_t points;
+      /// @brief The number of points waiting to be clustered by the worker
+      std::size_t pending_points;
+      /// @brief The time spent clustering, in seconds
+      double busy_time;
+      /// @brief The fraction of the lifetime of the pool spent clustering
+      double utilization;
+    };
+
+  private:
+    struct Worker {
+      Queue queue;
+      Clusterer<Ndim, value_type> clusterer;
+      std::optional<PointsDevice<Ndim, value_type>> d_points;
+      std::deque<std::packaged_task<void(Worker&)>> tasks;
+      std::condition_variable ready;
+      std::size_t device;
+      std::size_t events = 0;
+      std::size_t points = 0;
+      std::size_t pending_points = 0;
+      std::chrono::steady_clock::duration busy_time{};
+      std::thread thread;
+
+      Worker(const Device& dev,
+             std::size_t device_index,
+             value_type density_radius,
+             value_type min_density,
+             std::optional<value_type> outlier_distance,
+             std::optional<value_type> seeding_distance)
+          : queue{dev},
+            clusterer{queue, density_radius, min_density, outlier_distance, seeding_distance},
+            device{device_index} {}
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    mutable std::mutex m_mutex;
+    std::chrono::steady_clock::time_point m_start;
+    bool m_stop = false;
+
+    void run(Worker& worker);
+    // Stops the workers and joins the threads that have been started
+    void stop();
+
+  public:
+    /// @brief Construct a ClustererPool with its workers spread over the given devices
+    ///
+    /// @param devices The devices used by the workers, assigned in a round-robin fashion
+    /// @param n_workers The number of workers of the pool
+    /// @param density_radius Distance threshold for clustering
+    /// @param min_density Density threshold for clustering
+    /// @param outlier_distance Minimum distance between clusters. This parameter is optional and
+    /// by default density_radius is used.
+    /// @param seeding_distance Distance threshold for seed points. This parameter is optional and
+    /// by default density_radius is used.
+    ClustererPool(std::span<const Device> devices,
+                  std::size_t n_workers,
+                  value_type density_radius,
+                  value_type min_density,
+                  std::optional<value_type> outlier_distance = std::nullopt,
+                  std::optional<value_type> seeding_distance = std::nullopt);
+    /// @brief Construct a ClustererPool with its workers spread over all the available devices
+    ///
+    /// @param n_workers The number of workers of the pool
+    /// @param density_radius Distance threshold for clustering
+    /// @param min_density Density threshold for clustering
+    /// @param outlier_distance Minimum distance between clusters. This parameter is optional and
+    /// by default density_radius is used.
+    /// @param seeding_distance Distance threshold for seed points. This parameter is optional and
+    /// by default density_radius is used.
+    ClustererPool(std::size_t n_workers,
+                  value_type density_radius,
+                  value_type min_density,
+                  std::optional<value_type> outlier_distance = std::nullopt,
+                  std::optional<value_type> seeding_distance = std::nullopt);
+
+    ClustererPool(const ClustererPool&) = delete;
+    ClustererPool& operator=(const ClustererPool&) = delete;
+    ClustererPool(ClustererPool&&) = delete;
+    ClustererPool& operator=(ClustererPool&&) = delete;
+    /// @brief Waits for the submitted events to be clustered and stops the workers
+    ~ClustererPool();
+
+    /// @brief Submits an event to be clustered by one of the workers
+    ///
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param points Host points to cluster
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @return A future which becomes ready when the points have been clustered, and which
+    /// rethrows the exceptions raised by the clustering
+    /// @note The points must stay alive until the returned future is ready
+    template <
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    std::future<void> submit(PointsHost<Ndim, value_type>& points,
+                             const DistanceMetric& metric = DistanceMetric{},
+                             const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Returns the number of workers of the pool
+    ///
+    /// @return The number of workers
+    std::size_t size() const { return m_workers.size(); }
+
+    /// @brief Returns the usage statistics of each worker of the pool
+    ///
+    /// @return A vector containing the statistics of each worker
+    std::vector<WorkerStatistics> statistics() const;
+  };
+
+}  // namespace clue
+
+#include "CLUEstering/core/detail/ClustererPool.hpp"
@@ -24,6 +24,10 @@ namespace clue {
     value_type m_flat;
 
   public:
+    /// @brief The kernel value does not depend on the distance between the points, only on
+    /// whether the two points coincide
+    static constexpr bool distance_independent = true;
+
     /// @brief Construct a FlatKernel object
     ///
     /// @param flat The flat value for the kernel
@@ -108,6 +112,15 @@ namespace clue {
           { kernel(distance, point_i, point_j) };
         };
 
+    /// @brief Concept describing a convolutional kernel whose value does not depend on the distance
+    /// between the points, but only on whether the two points coincide.
+    /// The density of a point can then be accumulated tile by tile when a whole tile is contained in
+    /// the search radius.
+    template <typename TKernel>
+    concept distance_independent_kernel =
+        convolutional_kernel<TKernel> &&
+        requires { requires std::remove_cvref_t<TKernel>::distance_independent; };
+
   }  // namespace concepts
 
 }  // namespace clue
@@ -0,0 +1,141 @@
+/// @file EventBatcher.hpp
+/// @brief Provides the EventBatcher class, which packs small events into batches for clustering
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/core/Clusterer.hpp"
+#include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/DistanceMetrics.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace clue {
+
+  /// @brief The EventBatcher class collects many small events and clusters them together
+  /// through the batched Clusterer::make_clusters.
+  /// The coordinates and weights of the events are copied into pinned staging buffers, which are
+  /// flushed when they cannot hold the next event or when flush is called explicitly. After each
+  /// flush the cluster indexes of every event are written back to its own output, numbered from 0
+  /// as if the event had been clustered on its own.
+  ///
+  /// @tparam Ndim The number of dimensions of the points to cluster
+  /// @tparam TData The data type for the point coordinates and weights, which must be a
+  /// floating-point type. By default, it is set to `float`.
+  /// @tparam Kernel The type of convolutional kernel to use
+  /// @tparam DistanceMetric The type of distance metric to use
+  /// @note The outputs of the events must stay alive until the batch containing them is flushed.
+  /// Only the coordinates and weights of the events are used, so density uncertainties, sigmas
+  /// and tags set on PointsHost events are ignored.
+  template <std::size_t Ndim,
+            std::floating_point TData = float,
+            concepts::convolutional_kernel Kernel = FlatKernel<std::remove_cv_t<TData>>,
+            concepts::distance_metric<Ndim> DistanceMetric =
+                clue::EuclideanMetric<Ndim, std::remove_cv_t<TData>>>
+  class EventBatcher {
+  public:
+    using value_type = std::remove_cv_t<TData>;
+
+  private:
+    struct EventOutput {
+      std::span<int> cluster_indexes;
+      std::size_t* n_clusters;
+      PointsHost<Ndim, value_type>* points;
+    };
+
+    Clusterer<Ndim, value_type>& m_clusterer;
+    DistanceMetric m_metric;
+    Kernel m_kernel;
+    host_buffer<value_type[]> m_staging;
+    host_buffer<int[]> m_cluster_indexes;
+    std::vector<uint32_t> m_event_sizes;
+    std::vector<EventOutput> m_outputs;
+    std::size_t m_capacity;
+    std::size_t m_size;
+
+    // Returns the offset of the next event in the staging buffers, flushing them if it doesn't fit
+    std::size_t reserve(Queue& queue, std::size_t event_size);
+    void append(std::size_t event_size, const EventOutput& output);
+    void scatter(std::span<const int> cluster_indexes);
+
+  public:
+    /// @brief Construct an EventBatcher object
+    ///
+    /// @param queue The queue used to allocate the staging buffers
+    /// @param clusterer The clusterer used to cluster the batches, with its parameters
+    /// @param max_points The maximum number of points of a batch
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    template <concepts::queue TQueue>
+    EventBatcher(TQueue& queue,
+                 Clusterer<Ndim, value_type>& clusterer,
+                 std::size_t max_points,
+                 const DistanceMetric& metric = DistanceMetric{},
+                 const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    EventBatcher(const EventBatcher&) = delete;
+    EventBatcher& operator=(const EventBatcher&) = delete;
+    EventBatcher(EventBatcher&&) = default;
+    EventBatcher& operator=(EventBatcher&&) = delete;
+    ~EventBatcher() = default;
+
+    /// @brief Returns the number of points whose staging buffers fit in a memory budget
+    ///
+    /// @param bytes The memory budget in bytes
+    /// @return The maximum number of points of a batch fitting in the budget
+    static constexpr std::size_t capacity_for(std::size_t bytes) {
+      return bytes / ((Ndim + 1) * sizeof(value_type) + sizeof(int));
+    }
+
+    /// @brief Adds an event to the current batch
+    ///
+    /// @param queue The queue to use for the device operations
+    /// @param event The points of the event, whose cluster indexes are set when the batch is
+    /// flushed
+    /// @note If the event does not fit in the current batch, the batch is flushed first
+    void push(Queue& queue, PointsHost<Ndim, value_type>& event);
+    /// @brief Adds an event to the current batch
+    ///
+    /// @param queue The queue to use for the device operations
+    /// @param coordinates The coordinates of the points of the event, in SoA format
+    /// @param weights The weights of the points of the event
+    /// @param cluster_indexes The output buffer for the cluster indexes of the points of the event
+    /// @param n_clusters Optional output for the number of clusters found in the event
+    /// @note If the event does not fit in the current batch, the batch is flushed first
+    void push(Queue& queue,
+              std::span<const value_type> coordinates,
+              std::span<const value_type> weights,
+              std::span<int> cluster_indexes,
+              std::size_t* n_clusters = nullptr);
+
+    /// @brief Clusters the events of the current batch and writes back their results
+    ///
+    /// @param queue The queue to use for the device operations
+    void flush(Queue& queue);
+
+    /// @brief Returns the number of events in the current batch
+    ///
+    /// @return The number of events waiting to be clustered
+    std::size_t size() const { return m_event_sizes.size(); }
+    /// @brief Returns the number of points in the current batch
+    ///
+    /// @return The number of points waiting to be clustered
+    std::size_t n_points() const { return m_size; }
+    /// @brief Returns the maximum number of points of a batch
+    ///
+    /// @return The capacity of the staging buffers
+    std::size_t capacity() const { return m_capacity; }
+  };
+
+}  // namespace clue
+
+#include "CLUEstering/core/detail/EventBatcher.hpp"
@@ -0,0 +1,139 @@
+/// @file EventScheduler.hpp
+/// @brief Provides the EventScheduler class, which dispatches events across several backends
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/core/detail/ThroughputModel.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace clue {
+
+  /// @brief Description of a backend used by the EventScheduler
+  ///
+  /// @tparam Ndim The number of dimensions of the points to cluster
+  /// @tparam TData The data type for the point coordinates and weights
+  template <std::size_t Ndim, std::floating_point TData = float>
+  struct SchedulerBackend {
+    /// @brief The name of the backend, used in the statistics
+    std::string name;
+    /// @brief The number of events that the backend can cluster concurrently
+    std::size_t n_workers;
+    /// @brief Clusters an event on the backend, called with the index of the worker
+    ///
+    /// @note Each worker calls the function from its own thread, so calls with different worker
+    /// indexes can run concurrently
+    std::function<void(std::size_t, PointsHost<Ndim, TData>&)> process;
+  };
+
+  /// @brief The EventScheduler class clusters a stream of events on several backends at once,
+  /// for instance a CPU and a GPU backend compiled in different translation units.
+  /// Each event is dispatched to the backend with the lowest predicted completion time, computed
+  /// from the work already queued on it and from an online estimate of its clustering time as a
+  /// function of the event size.
+  ///
+  /// @tparam Ndim The number of dimensions of the points to cluster
+  /// @tparam TData The data type for the point coordinates and weights, which must be a
+  /// floating-point type. By default, it is set to `float`.
+  template <std::size_t Ndim, std::floating_point TData = float>
+  class EventScheduler {
+  public:
+    using value_type = std::remove_cv_t<TData>;
+    using Backend = SchedulerBackend<Ndim, value_type>;
+
+    /// @brief Usage statistics of a backend of the scheduler
+    struct BackendStatistics {
+      /// @brief The name of the backend
+      std::string name;
+      /// @brief The number of events clustered by the backend
+      std::size_t events;
+      /// @brief The number of points clustered by the backend
+      std::size_t points;
+      /// @brief The time spent clustering by all the workers of the backend, in seconds
+      double busy_time;
+      /// @brief The average throughput of the workers of the backend, in points per second
+      double throughput;
+    };
+
+  private:
+    struct Task {
+      PointsHost<Ndim, value_type>* points;
+      double predicted_time;
+      std::promise<void> promise;
+    };
+
+    struct BackendState {
+      Backend backend;
+      detail::ThroughputModel model;
+      std::deque<Task> tasks;
+      std::condition_variable ready;
+      std::vector<std::thread> threads;
+      double pending_time = 0.;
+      std::size_t pending_events = 0;
+      std::size_t events = 0;
+      std::size_t points = 0;
+      std::chrono::steady_clock::duration busy_time{};
+
+      explicit BackendState(Backend b) : backend{std::move(b)} {}
+    };
+
+    std::vector<std::unique_ptr<BackendState>> m_backends;
+    mutable std::mutex m_mutex;
+    bool m_stop = false;
+
+    void run(BackendState& state, std::size_t worker);
+    // Returns the predicted clustering time of an event on a backend, or nothing if the backend
+    // has not been measured yet
+    std::optional<double> predict(const BackendState& state, std::size_t n_points) const;
+    BackendState& choose_backend(std::size_t n_points, double& predicted_time);
+
+  public:
+    /// @brief Construct an EventScheduler and start the workers of its backends
+    ///
+    /// @param backends The backends among which the events are dispatched
+    explicit EventScheduler(std::vector<Backend> backends);
+
+    EventScheduler(const EventScheduler&) = delete;
+    EventScheduler& operator=(const EventScheduler&) = delete;
+    EventScheduler(EventScheduler&&) = delete;
+    EventScheduler& operator=(EventScheduler&&) = delete;
+    /// @brief Waits for the submitted events to be clustered and stops the workers
+    ~EventScheduler();
+
+    /// @brief Submits an event to be clustered on the backend expected to finish it first
+    ///
+    /// @param points Host points to cluster
+    /// @return A future which becomes ready when the points have been clustered, and which
+    /// rethrows the exceptions raised by the backend
+    /// @note The points must stay alive until the returned future is ready
+    std::future<void> submit(PointsHost<Ndim, value_type>& points);
+
+    /// @brief Returns the number of backends of the scheduler
+    ///
+    /// @return The number of backends
+    std::size_t size() const { return m_backends.size(); }
+
+    /// @brief Returns the usage statistics of each backend of the scheduler
+    ///
+    /// @return A vector containing the statistics of each backend
+    std::vector<BackendStatistics> statistics() const;
+  };
+
+}  // namespace clue
+
+#include "CLUEstering/core/detail/EventScheduler.hpp"
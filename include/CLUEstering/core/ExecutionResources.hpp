@@ -0,0 +1,29 @@
+/// @file ExecutionResources.hpp
+/// @brief Defines the execution resources that the CPU backends can use for clustering
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace clue {
+
+  /// @brief Execution resources used by a Clusterer on the CPU backends
+  ///
+  /// @note With the TBB backend the kernels of the clustering run in a task arena with this number
+  /// of threads, leaving the parallelism of the rest of the application unchanged, and with the
+  /// OpenMP backend it sets the number of threads of the parallel regions. The serial and GPU
+  /// backends ignore it.
+  struct ExecutionResources {
+    /// @brief The maximum number of threads, where 0 keeps the default of the backend
+    std::size_t n_threads = 0;
+    /// @brief The cores to which the threads are pinned, where an empty list leaves the placement
+    /// to the operating system
+    ///
+    /// @note Pinning is only supported on Linux. The worker threads of TBB and OpenMP stay
+    /// pinned after the clustering, while the calling thread gets its affinity restored.
+    std::vector<int> cores;
+  };
+
+}  // namespace clue
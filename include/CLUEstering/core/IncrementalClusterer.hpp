@@ -0,0 +1,220 @@
+/// @file IncrementalClusterer.hpp
+/// @brief Provides the IncrementalClusterer class, which updates a clustering as points are
+/// inserted and removed
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/core/Clusterer.hpp"
+#include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/DistanceMetrics.hpp"
+#include "CLUEstering/core/detail/defines.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace clue {
+
+  /// @brief The IncrementalClusterer class keeps the points of a clustering alive between
+  /// updates, so that inserting or removing a few points doesn't require to bin all of them again.
+  /// The points are stored in slots, and a point inserted in the same update in which another is
+  /// removed takes its slot. When the number of points doesn't change, the points are clustered
+  /// with Clusterer::update_positions, which rebins in the tiles only the slots whose point moved
+  /// to a different tile. Otherwise the removed slots are filled with the last points and the
+  /// points are clustered from scratch.
+  /// The results are the ones of a Clusterer run on the current points, listed in the order of
+  /// their slots, which is returned by points().
+  ///
+  /// @tparam Ndim The number of dimensions of the points to cluster
+  /// @tparam TData The data type for the point coordinates and weights, which must be a
+  /// floating-point type. By default, it is set to `float`.
+  /// @tparam Kernel The type of convolutional kernel to use
+  /// @tparam DistanceMetric The type of distance metric to use
+  /// @note The points have no tags, so the metrics reading the sigmas of the points are not
+  /// supported.
+  /// @note Each point is identified by the index returned when it is inserted. The index of a
+  /// removed point can be given to a point inserted later.
+  template <std::size_t Ndim,
+            std::floating_point TData = float,
+            concepts::convolutional_kernel Kernel = FlatKernel<std::remove_cv_t<TData>>,
+            concepts::distance_metric<Ndim> DistanceMetric =
+                clue::EuclideanMetric<Ndim, std::remove_cv_t<TData>>>
+  class IncrementalClusterer {
+  public:
+    using value_type = std::remove_cv_t<TData>;
+
+  private:
+    Clusterer<Ndim, value_type> m_clusterer;
+    DistanceMetric m_metric;
+    Kernel m_kernel;
+    std::optional<PointsDevice<Ndim, value_type>> m_dev_points;
+    // the coordinates and the weight of the point of each slot
+    std::vector<Point<Ndim, value_type>> m_points;
+    // the index of the point of each slot, and the slot of each point index
+    std::vector<int32_t> m_indexes;
+    std::vector<int32_t> m_slots;
+    std::vector<int32_t> m_free_indexes;
+    // the input buffer of the host points, in SoA format, and the cluster index of each slot
+    std::vector<value_type> m_input;
+    std::vector<int> m_cluster_index;
+    std::size_t m_n_clusters;
+    std::size_t m_updated_points;
+
+    void recluster(Queue& queue);
+
+  public:
+    /// @brief Construct an IncrementalClusterer object with no points
+    ///
+    /// @param queue The queue to use for the device operations
+    /// @param density_radius Distance threshold for clustering
+    /// @param min_density Density threshold for clustering
+    /// @param outlier_distance Minimum distance between clusters. This parameter is optional and
+    /// by default density_radius is used.
+    /// @param seeding_distance Distance threshold for seed points. This parameter is optional and
+    /// by default density_radius is used.
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    IncrementalClusterer(Queue& queue,
+                         value_type density_radius,
+                         value_type min_density,
+                         std::optional<value_type> outlier_distance = std::nullopt,
+                         std::optional<value_type> seeding_distance = std::nullopt,
+                         const DistanceMetric& metric = DistanceMetric{},
+                         const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Removes and inserts a batch of points, updating the clustering once
+    ///
+    /// @param queue The queue to use for the device operations
+    /// @param removed The indexes of the points to remove
+    /// @param coordinates The coordinates of the points to insert, in SoA format
+    /// @param weights The weights of the points to insert
+    /// @return The indexes assigned to the inserted points
+    std::vector<int32_t> update(Queue& queue,
+                                std::span<const int32_t> removed,
+                                std::span<const value_type> coordinates,
+                                std::span<const value_type> weights);
+    /// @brief Inserts a batch of points
+    ///
+    /// @param queue The queue to use for the device operations
+    /// @param coordinates The coordinates of the points to insert, in SoA format
+    /// @param weights The weights of the points to insert
+    /// @return The indexes assigned to the inserted points
+    std::vector<int32_t> insert(Queue& queue,
+                                std::span<const value_type> coordinates,
+                                std::span<const value_type> weights) {
+      return update(queue, {}, coordinates, weights);
+    }
+    /// @brief Removes a batch of points
+    ///
+    /// @param queue The queue to use for the device operations
+    /// @param removed The indexes of the points to remove
+    void remove(Queue& queue, std::span<const int32_t> removed) {
+      update(queue, removed, {}, {});
+    }
+
+    /// @brief Checks whether a point index refers to a point of the clustering
+    ///
+    /// @param point The index of the point
+    /// @return True if the point has been inserted and not removed
+    bool contains(int32_t point) const {
+      return point >= 0 && static_cast<std::size_t>(point) < m_slots.size() &&
+             m_slots[point] != -1;
+    }
+    /// @brief Returns the cluster index of a point
+    ///
+    /// @param point The index of the point
+    /// @return The index of the cluster of the point, or -1 if it is an outlier
+    int32_t cluster_index(int32_t point) const;
+
+    /// @brief Returns the indexes of the points in the order of their slots
+    ///
+    /// @return The indexes of the points, in the order in which they are clustered
+    const std::vector<int32_t>& points() const { return m_indexes; }
+    /// @brief Returns the number of points of the clustering
+    ///
+    /// @return The number of points inserted and not removed
+    std::size_t size() const { return m_indexes.size(); }
+    /// @brief Returns the number of clusters
+    ///
+    /// @return The number of clusters of the current points
+    std::size_t n_clusters() const { return m_n_clusters; }
+    /// @brief Returns the number of points rebinned in the tiles by the last update
+    ///
+    /// @return The number of points moved to a different tile, equal to the number of points if
+    /// they were clustered from scratch
+    std::size_t updated_points() const { return m_updated_points; }
+    /// @brief Returns the clusterer running the updates, to set its options
+    ///
+    /// @return The clusterer of the points
+    Clusterer<Ndim, value_type>& clusterer() { return m_clusterer; }
+  };
+
+  /// @brief The SlidingWindow class keeps the most recent points of a stream in an
+  /// IncrementalClusterer, evicting the oldest ones in the same update that inserts the new ones.
+  ///
+  /// @tparam Ndim The number of dimensions of the points to cluster
+  /// @tparam TData The data type for the point coordinates and weights
+  /// @tparam Kernel The type of convolutional kernel to use
+  /// @tparam DistanceMetric The type of distance metric to use
+  template <std::size_t Ndim,
+            std::floating_point TData = float,
+            concepts::convolutional_kernel Kernel = FlatKernel<std::remove_cv_t<TData>>,
+            concepts::distance_metric<Ndim> DistanceMetric =
+                clue::EuclideanMetric<Ndim, std::remove_cv_t<TData>>>
+  class SlidingWindow {
+  public:
+    using value_type = std::remove_cv_t<TData>;
+    using Clusterer = IncrementalClusterer<Ndim, value_type, Kernel, DistanceMetric>;
+
+  private:
+    Clusterer& m_clusterer;
+    std::deque<int32_t> m_window;
+    std::size_t m_capacity;
+
+  public:
+    /// @brief Construct a SlidingWindow object
+    ///
+    /// @param clusterer The clusterer holding the points of the window, which must be empty
+    /// @param capacity The maximum number of points of the window
+    SlidingWindow(Clusterer& clusterer, std::size_t capacity);
+
+    /// @brief Inserts a batch of points, evicting the oldest points exceeding the capacity
+    ///
+    /// @param queue The queue to use for the device operations
+    /// @param coordinates The coordinates of the points to insert, in SoA format
+    /// @param weights The weights of the points to insert
+    /// @return The indexes assigned to the inserted points
+    std::vector<int32_t> push(Queue& queue,
+                              std::span<const value_type> coordinates,
+                              std::span<const value_type> weights);
+    /// @brief Evicts the oldest points of the window
+    ///
+    /// @param queue The queue to use for the device operations
+    /// @param n_points The number of points to evict
+    void evict(Queue& queue, std::size_t n_points);
+
+    /// @brief Returns the indexes of the points of the window, from the oldest to the newest
+    ///
+    /// @return The indexes of the points in the window
+    const std::deque<int32_t>& points() const { return m_window; }
+    /// @brief Returns the number of points of the window
+    ///
+    /// @return The number of points currently in the window
+    std::size_t size() const { return m_window.size(); }
+    /// @brief Returns the maximum number of points of the window
+    ///
+    /// @return The capacity of the window
+    std::size_t capacity() const { return m_capacity; }
+  };
+
+}  // namespace clue
+
+#include "CLUEstering/core/detail/IncrementalClusterer.hpp"
@@ -0,0 +1,204 @@
+/// @file OutOfCoreClusterer.hpp
+/// @brief Provides the OutOfCoreClusterer class, which clusters datasets larger than the memory
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/core/Clusterer.hpp"
+#include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/DistanceMetrics.hpp"
+#include "CLUEstering/core/detail/defines.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace clue {
+
+  /// @brief The OutOfCoreClusterer class clusters datasets stored in files larger than the host
+  /// or device memory.
+  /// The input file is memory-mapped and split in chunks along its longest axis. Each chunk is
+  /// extended by a halo wide enough for the results of the points it owns to be exact, then it is
+  /// gathered into one of a bounded number of staging and device buffers and clustered with a
+  /// Clusterer. Only the follower chains leaving a chunk are kept in memory, and are stitched once
+  /// all the chunks have been clustered. The cluster indexes are written to a memory-mapped
+  /// output file.
+  ///
+  /// @tparam Ndim The number of dimensions of the points to cluster
+  /// @tparam TData The data type for the point coordinates and weights, which must be a
+  /// floating-point type. By default, it is set to `float`.
+  /// @note The input file contains the points one after the other, each stored as its Ndim
+  /// coordinates followed by its weight, in the native binary representation of TData. The
+  /// output file contains one 32-bit cluster index per point, with -1 for the outliers.
+  /// @note As for the ShardedClusterer, the distance metric must never be shorter than the
+  /// coordinate difference along any axis.
+  template <std::size_t Ndim, std::floating_point TData = float>
+  class OutOfCoreClusterer {
+  public:
+    using value_type = std::remove_cv_t<TData>;
+
+  private:
+    // Histogram of the points along the axis of the chunks
+    struct Binning {
+      std::size_t axis;
+      value_type min;
+      value_type width;
+      std::size_t n_bins;
+
+      std::size_t bin(value_type coordinate) const;
+    };
+
+    struct Chunk {
+      // the bins owned by the chunk
+      std::size_t first_bin;
+      std::size_t last_bin;
+      // the bins of the chunk including its halo, with last_halo_bin excluded
+      std::size_t first_halo_bin;
+      std::size_t last_halo_bin;
+      // the range of the indexes of the points of the chunk in the index file
+      std::size_t offset;
+      std::size_t size;
+      std::size_t owned;
+    };
+
+    struct Slot {
+      Queue queue;
+      Clusterer<Ndim, value_type> clusterer;
+      host_buffer<std::byte[]> h_buffer;
+      device_buffer<Device, std::byte[]> d_buffer;
+      std::vector<int32_t> nearest_higher;
+      std::vector<int32_t> is_seed;
+      std::vector<bool> owned;
+      std::size_t chunk;
+      std::future<void> result;
+
+      Slot(const Device& device,
+           std::size_t capacity,
+           value_type density_radius,
+           value_type min_density,
+           std::optional<value_type> outlier_distance,
+           std::optional<value_type> seeding_distance);
+    };
+
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::vector<Chunk> m_chunks;
+    std::vector<std::pair<int64_t, int64_t>> m_pending;
+    std::size_t m_capacity;
+    std::size_t m_n_bins;
+    value_type m_halo_width;
+    int32_t m_n_clusters;
+
+    Binning make_binning(std::span<const value_type> points, std::size_t n_points) const;
+    void make_chunks(std::span<const value_type> points,
+                     std::size_t n_points,
+                     const Binning& binning);
+    void fill_indexes(std::span<const value_type> points,
+                      std::size_t n_points,
+                      const Binning& binning,
+                      std::span<int64_t> indexes) const;
+    template <concepts::convolutional_kernel Kernel, concepts::distance_metric<Ndim> DistanceMetric>
+    void cluster_chunk(Slot& slot,
+                       std::span<const value_type> points,
+                       std::span<const int64_t> indexes,
+                       const Binning& binning,
+                       const DistanceMetric& metric,
+                       const Kernel& kernel) const;
+    // Labels the points owned by the chunk of a slot, keeping the chains that leave the chunk
+    void assign_chunk(Slot& slot, std::span<const int64_t> indexes, std::span<int32_t> labels);
+    void stitch(std::span<int32_t> labels) const;
+
+  public:
+    /// @brief Construct an OutOfCoreClusterer object
+    ///
+    /// @param device The device used to cluster the chunks
+    /// @param chunk_points The maximum number of points of a chunk, including its halo
+    /// @param n_buffers The number of chunks processed concurrently, each with its own staging
+    /// and device buffers
+    /// @param density_radius Distance threshold for clustering
+    /// @param min_density Density threshold for clustering
+    /// @param outlier_distance Minimum distance between clusters. This parameter is optional and
+    /// by default density_radius is used.
+    /// @param seeding_distance Distance threshold for seed points. This parameter is optional and
+    /// by default density_radius is used.
+    OutOfCoreClusterer(const Device& device,
+                       std::size_t chunk_points,
+                       std::size_t n_buffers,
+                       value_type density_radius,
+                       value_type min_density,
+                       std::optional<value_type> outlier_distance = std::nullopt,
+                       std::optional<value_type> seeding_distance = std::nullopt);
+    /// @brief Construct an OutOfCoreClusterer object on the first available device
+    ///
+    /// @param chunk_points The maximum number of points of a chunk, including its halo
+    /// @param n_buffers The number of chunks processed concurrently, each with its own staging
+    /// and device buffers
+    /// @param density_radius Distance threshold for clustering
+    /// @param min_density Density threshold for clustering
+    /// @param outlier_distance Minimum distance between clusters. This parameter is optional and
+    /// by default density_radius is used.
+    /// @param seeding_distance Distance threshold for seed points. This parameter is optional and
+    /// by default density_radius is used.
+    OutOfCoreClusterer(std::size_t chunk_points,
+                       std::size_t n_buffers,
+                       value_type density_radius,
+                       value_type min_density,
+                       std::optional<value_type> outlier_distance = std::nullopt,
+                       std::optional<value_type> seeding_distance = std::nullopt);
+
+    OutOfCoreClusterer(const OutOfCoreClusterer&) = delete;
+    OutOfCoreClusterer& operator=(const OutOfCoreClusterer&) = delete;
+    OutOfCoreClusterer(OutOfCoreClusterer&&) = default;
+    OutOfCoreClusterer& operator=(OutOfCoreClusterer&&) = default;
+    ~OutOfCoreClusterer() = default;
+
+    /// @brief Set the number of bins of the histogram used to cut the chunks
+    ///
+    /// @param n_bins The number of bins along the axis of the chunks, 65536 by default
+    /// @note Finer bins give chunks closer to the maximum size, at the cost of a larger histogram
+    void setHistogramBins(std::size_t n_bins);
+
+    /// @brief Construct the clusters of the points stored in a file
+    ///
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param input_path The path of the file containing the points
+    /// @param output_path The path of the file where the cluster indexes are written
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @return The number of clusters found
+    /// @note A temporary file holding the indexes of the points of each chunk is created next to
+    /// the output file and removed right away. The clusters are numbered chunk by chunk along
+    /// the axis of the chunks, and within a chunk in the order of the indexes of their seeds, so
+    /// the numbering can differ from the one of a single Clusterer.
+    template <
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    std::size_t make_clusters(const std::string& input_path,
+                              const std::string& output_path,
+                              const DistanceMetric& metric = DistanceMetric{},
+                              const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Returns the number of chunks of the last clustering run
+    ///
+    /// @return The number of chunks the points were split in
+    std::size_t n_chunks() const { return m_chunks.size(); }
+    /// @brief Returns the width of the halo added on each side of a chunk
+    ///
+    /// @return The halo width, equal to the density radius plus the largest of the outlier and
+    /// seeding distances
+    value_type halo_width() const { return m_halo_width; }
+  };
+
+}  // namespace clue
+
+#include "CLUEstering/core/detail/OutOfCoreClusterer.hpp"
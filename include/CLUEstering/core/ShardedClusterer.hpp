@@ -0,0 +1,148 @@
+/// @file ShardedClusterer.hpp
+/// @brief Provides the ShardedClusterer class, which splits the clustering of a dataset in slabs
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include "CLUEstering/core/Clusterer.hpp"
+#include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/DistanceMetrics.hpp"
+#include "CLUEstering/core/detail/defines.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace clue {
+
+  /// @brief The ShardedClusterer class clusters a dataset by splitting it in slabs along its
+  /// longest axis, each clustered by its own Clusterer on its own queue.
+  /// Every slab is extended by a halo of points owned by its neighbours, wide enough for the
+  /// densities, nearest-highers and seeds of the points it owns to be the same as if the whole
+  /// dataset was clustered at once. The clusters are then stitched by following the
+  /// nearest-higher links of the points across the slab boundaries.
+  ///
+  /// @tparam Ndim The number of dimensions of the points to cluster
+  /// @tparam TData The data type for the point coordinates and weights, which must be a
+  /// floating-point type. By default, it is set to `float`.
+  /// @note The halo is measured along the axis of the slabs, so the distance metric must never
+  /// be shorter than the coordinate difference along any axis, as for the Euclidean, Manhattan
+  /// and Chebyshev metrics. Wrapped coordinates, density uncertainties and coordinate sigmas are
+  /// not supported.
+  template <std::size_t Ndim, std::floating_point TData = float>
+  class ShardedClusterer {
+  public:
+    using value_type = std::remove_cv_t<TData>;
+
+  private:
+    struct Shard {
+      Queue queue;
+      Clusterer<Ndim, value_type> clusterer;
+      // the global indexes of the points of the slab, including its halo, in increasing order
+      std::vector<int32_t> indexes;
+      std::vector<uint32_t> tags;
+      std::vector<int32_t> nearest_higher;
+      std::vector<int32_t> is_seed;
+      value_type begin;
+      value_type end;
+
+      Shard(const Device& device,
+            value_type density_radius,
+            value_type min_density,
+            std::optional<value_type> outlier_distance,
+            std::optional<value_type> seeding_distance)
+          : queue{device},
+            clusterer{queue, density_radius, min_density, outlier_distance, seeding_distance},
+            begin{},
+            end{} {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    value_type m_halo_width;
+
+    // Sets the owned range of each shard, splitting the points in slabs of similar size
+    void partition(std::span<const value_type> coordinates);
+    template <concepts::convolutional_kernel Kernel, concepts::distance_metric<Ndim> DistanceMetric>
+    void cluster_shard(Shard& shard,
+                       const PointsHost<Ndim, value_type>& points,
+                       std::size_t axis,
+                       const DistanceMetric& metric,
+                       const Kernel& kernel);
+    void stitch(PointsHost<Ndim, value_type>& points, std::size_t axis) const;
+
+  public:
+    /// @brief Construct a ShardedClusterer with its shards spread over the given devices
+    ///
+    /// @param devices The devices used by the shards, assigned in a round-robin fashion
+    /// @param n_shards The number of slabs in which the points are split
+    /// @param density_radius Distance threshold for clustering
+    /// @param min_density Density threshold for clustering
+    /// @param outlier_distance Minimum distance between clusters. This parameter is optional and
+    /// by default density_radius is used.
+    /// @param seeding_distance Distance threshold for seed points. This parameter is optional and
+    /// by default density_radius is used.
+    ShardedClusterer(std::span<const Device> devices,
+                     std::size_t n_shards,
+                     value_type density_radius,
+                     value_type min_density,
+                     std::optional<value_type> outlier_distance = std::nullopt,
+                     std::optional<value_type> seeding_distance = std::nullopt);
+    /// @brief Construct a ShardedClusterer with its shards spread over all the available devices
+    ///
+    /// @param n_shards The number of slabs in which the points are split
+    /// @param density_radius Distance threshold for clustering
+    /// @param min_density Density threshold for clustering
+    /// @param outlier_distance Minimum distance between clusters. This parameter is optional and
+    /// by default density_radius is used.
+    /// @param seeding_distance Distance threshold for seed points. This parameter is optional and
+    /// by default density_radius is used.
+    ShardedClusterer(std::size_t n_shards,
+                     value_type density_radius,
+                     value_type min_density,
+                     std::optional<value_type> outlier_distance = std::nullopt,
+                     std::optional<value_type> seeding_distance = std::nullopt);
+
+    ShardedClusterer(const ShardedClusterer&) = delete;
+    ShardedClusterer& operator=(const ShardedClusterer&) = delete;
+    ShardedClusterer(ShardedClusterer&&) = default;
+    ShardedClusterer& operator=(ShardedClusterer&&) = default;
+    ~ShardedClusterer() = default;
+
+    /// @brief Construct the clusters from host points
+    ///
+    /// @tparam Kernel The type of convolutional kernel to use
+    /// @tparam DistanceMetric The type of distance metric to use
+    /// @param points Host points to cluster
+    /// @param metric The distance metric to use for clustering, default is EuclideanMetric
+    /// @param kernel The convolutional kernel to use for computing the local densities,
+    /// default is FlatKernel with height 0.5
+    /// @note The slabs are clustered concurrently, each from its own thread. The clusters are
+    /// numbered in the order of the indexes of their seeds.
+    template <
+        concepts::convolutional_kernel Kernel = FlatKernel<value_type>,
+        concepts::distance_metric<Ndim> DistanceMetric = clue::EuclideanMetric<Ndim, value_type>>
+    void make_clusters(PointsHost<Ndim, value_type>& points,
+                       const DistanceMetric& metric = DistanceMetric{},
+                       const Kernel& kernel = FlatKernel<value_type>{.5f});
+
+    /// @brief Returns the number of shards
+    ///
+    /// @return The number of slabs in which the points are split
+    std::size_t size() const { return m_shards.size(); }
+    /// @brief Returns the width of the halo added on each side of a slab
+    ///
+    /// @return The halo width, equal to the density radius plus the largest of the outlier and
+    /// seeding distances
+    value_type halo_width() const { return m_halo_width; }
+  };
+
+}  // namespace clue
+
+#include "CLUEstering/core/detail/ShardedClusterer.hpp"
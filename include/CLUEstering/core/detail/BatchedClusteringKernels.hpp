@@ -4,14 +4,19 @@
 #include "CLUEstering/core/ConvolutionalKernel.hpp"
 #include "CLUEstering/core/DistanceMetrics.hpp"
 #include "CLUEstering/core/detail/ClusteringKernels.hpp"
+#include "CLUEstering/data_structures/EventBatch.hpp"
 #include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/internal/CoordinateExtremes.hpp"
 #include "CLUEstering/data_structures/internal/PointsCommon.hpp"
 #include "CLUEstering/data_structures/internal/DeviceVector.hpp"
+#include "CLUEstering/data_structures/internal/FindEvent.hpp"
 #include "CLUEstering/data_structures/internal/SearchBox.hpp"
 #include "CLUEstering/data_structures/internal/SeedArray.hpp"
 #include "CLUEstering/data_structures/internal/TilesView.hpp"
 #include "CLUEstering/detail/make_array.hpp"
 #include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/algorithm/scan/scan.hpp"
+#include "CLUEstering/internal/alpaka/exec.hpp"
 #include "CLUEstering/internal/alpaka/work_division.hpp"
 #include "CLUEstering/internal/nostd/ceil_div.hpp"
 #include "CLUEstering/internal/math/math.hpp"
@@ -22,9 +27,282 @@
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
 
 namespace clue::detail {
 
+  // Clustering parameters of the events of a batch, read from the per-event parameters when
+  // they are given and from the parameters of the clusterer otherwise
+  template <std::floating_point TData>
+  struct EventParametersView {
+    const EventParameters<TData>* per_event;
+    EventParameters<TData> common;
+
+    ALPAKA_FN_HOST_ACC EventParameters<TData> operator[](std::size_t event) const {
+      return (per_event != nullptr) ? per_event[event] : common;
+    }
+  };
+
+  // Shared memory reserved by the block-per-event kernel, which bounds the size of the events it
+  // can cluster: each point needs its coordinates and weight, density, nearest-higher and two
+  // words for the scan of the seeds
+  inline constexpr std::size_t event_block_shared_bytes = 32 * 1024;
+
+  template <std::size_t Ndim, typename TData>
+  inline constexpr std::size_t max_block_event_size =
+      event_block_shared_bytes / ((Ndim + 2) * sizeof(TData) + 3 * sizeof(int32_t));
+
+  // Clusters each event entirely inside one block, comparing all the pairs of points of the
+  // event from shared memory. The cluster indexes are local to the event and the number of seeds
+  // of each event is written in event_seeds[event + 1], to be turned into offsets afterwards.
+  struct KernelClusterEventsPerBlock {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              concepts::convolutional_kernel KernelType,
+              concepts::distance_metric<Ndim> DistanceMetric>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim, TData> points,
+                                  const KernelType& kernel,
+                                  EventParametersView<std::remove_cv_t<TData>> parameters,
+                                  DistanceMetric metric,
+                                  const std::size_t* event_offsets,
+                                  std::size_t batch_size,
+                                  int32_t* event_seeds) const {
+      using value_type = std::remove_cv_t<TData>;
+      constexpr auto capacity = max_block_event_size<Ndim, value_type>;
+      auto& coords = alpaka::declareSharedVar<std::array<std::array<value_type, Ndim + 1>, capacity>,
+                                              __COUNTER__>(acc);
+      auto& rho = alpaka::declareSharedVar<std::array<value_type, capacity>, __COUNTER__>(acc);
+      auto& nearest_higher =
+          alpaka::declareSharedVar<std::array<int32_t, capacity>, __COUNTER__>(acc);
+      auto& seed_scan = alpaka::declareSharedVar<std::array<int32_t, capacity>, __COUNTER__>(acc);
+      auto& scan_buffer = alpaka::declareSharedVar<std::array<int32_t, capacity>, __COUNTER__>(acc);
+
+      auto tag = [&points](std::integral auto idx) -> std::size_t {
+        return (points.has_tags()) ? points.tags()[idx] : static_cast<std::size_t>(idx);
+      };
+
+      for (auto event : alpaka::independentGroups(acc, batch_size)) {
+        const auto first = event_offsets[event];
+        const auto event_size = event_offsets[event + 1] - first;
+        assert(event_size <= capacity);
+        const auto event_parameters = parameters[event];
+
+        auto distance = [&](auto i, auto j) -> value_type {
+          if constexpr (concepts::detail::view_distance_metric<DistanceMetric, Ndim>) {
+            return metric(points, first + i, first + j);
+          } else {
+            return metric(coords[i], coords[j]);
+          }
+        };
+
+        for (auto i : alpaka::independentGroupElements(acc, event_size))
+          coords[i] = points[first + i];
+        alpaka::syncBlockThreads(acc);
+
+        for (auto i : alpaka::independentGroupElements(acc, event_size)) {
+          auto rho_i = value_type{0};
+          for (auto j = 0u; j < event_size; ++j) {
+            const auto distance_ij = distance(i, j);
+            if (distance_ij <= event_parameters.density_radius)
+              rho_i += kernel(distance_ij,
+                              static_cast<int32_t>(first + i),
+                              static_cast<int32_t>(first + j)) *
+                       coords[j][Ndim];
+          }
+          rho[i] = rho_i;
+          points.rho()[first + i] = rho_i;
+        }
+        alpaka::syncBlockThreads(acc);
+
+        for (auto i : alpaka::independentGroupElements(acc, event_size)) {
+          const auto rho_i = rho[i];
+          const auto tag_i = tag(first + i);
+          const auto density_uncertainty =
+              points.has_uncertainty() ? points.density_uncertainty()[first + i] : value_type{1.};
+          const auto effective_min_density = event_parameters.min_density * density_uncertainty;
+          const auto effective_distance = (rho_i >= effective_min_density)
+                                              ? event_parameters.seeding_distance
+                                              : event_parameters.outlier_distance;
+
+          auto delta_i = std::numeric_limits<value_type>::max();
+          int32_t nh_i = -1;
+          for (auto j = 0u; j < event_size; ++j) {
+            const auto rho_j = rho[j];
+            const auto tag_j = tag(first + j);
+            const bool higher = (rho_j > rho_i) ||
+                                ((rho_j == rho_i) && (rho_j > value_type{0}) && (tag_j > tag_i));
+            if (!higher)
+              continue;
+
+            const auto distance_ij = distance(i, j);
+            if (distance_ij <= effective_distance &&
+                ((distance_ij < delta_i) ||
+                 ((distance_ij == delta_i) && (nh_i >= 0) &&
+                  ((rho_j > rho[nh_i]) ||
+                   ((rho_j == rho[nh_i]) && (tag_j > tag(first + nh_i))))))) {
+              delta_i = distance_ij;
+              nh_i = static_cast<int32_t>(j);
+            }
+          }
+
+          const bool is_seed = (nh_i == -1) && (rho_i >= effective_min_density);
+          nearest_higher[i] = nh_i;
+          seed_scan[i] = is_seed;
+          points.nearest_higher()[first + i] =
+              (nh_i >= 0) ? static_cast<int32_t>(first + nh_i) : -1;
+          points.is_seed()[first + i] = is_seed;
+        }
+        alpaka::syncBlockThreads(acc);
+
+        // inclusive scan of the seed flags, giving the local cluster index of each seed
+        auto* scan_in = seed_scan.data();
+        auto* scan_out = scan_buffer.data();
+        for (auto offset = 1u; offset < event_size; offset *= 2) {
+          for (auto i : alpaka::independentGroupElements(acc, event_size))
+            scan_out[i] = scan_in[i] + ((i >= offset) ? scan_in[i - offset] : 0);
+          alpaka::syncBlockThreads(acc);
+          auto* swap = scan_in;
+          scan_in = scan_out;
+          scan_out = swap;
+        }
+        auto is_seed = [&](auto i) { return scan_in[i] > ((i > 0) ? scan_in[i - 1] : 0); };
+
+        for (auto i : alpaka::independentGroupElements(acc, event_size)) {
+          auto current = static_cast<int32_t>(i);
+          while (!is_seed(current) && nearest_higher[current] != -1)
+            current = nearest_higher[current];
+          points.cluster_index()[first + i] = is_seed(current) ? scan_in[current] - 1 : -1;
+        }
+        if (alpaka::oncePerBlock(acc))
+          event_seeds[event + 1] = (event_size > 0) ? scan_in[event_size - 1] : 0;
+        // the shared memory is reused by the next event of the block
+        alpaka::syncBlockThreads(acc);
+      }
+    }
+  };
+
+  // Shifts the local cluster indexes of each event by the number of seeds of the previous events
+  // and lists the seeds and their events
+  struct KernelOffsetEventClusters {
+    template <typename TAcc, std::size_t Ndim, std::floating_point TData>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim, TData> points,
+                                  clue::internal::SeedArrayView seeds,
+                                  clue::internal::DeviceVectorView event_associations,
+                                  const std::size_t* event_offsets,
+                                  const int32_t* event_cluster_offsets,
+                                  std::size_t batch_size) const {
+      for (auto event : alpaka::independentGroups(acc, batch_size)) {
+        const auto first = event_offsets[event];
+        const auto event_size = event_offsets[event + 1] - first;
+        const auto cluster_offset = event_cluster_offsets[event];
+        for (auto i : alpaka::independentGroupElements(acc, event_size)) {
+          const auto local_cluster = points.cluster_index()[first + i];
+          if (local_cluster < 0)
+            continue;
+
+          const auto cluster = cluster_offset + local_cluster;
+          points.cluster_index()[first + i] = cluster;
+          if (points.is_seed()[first + i]) {
+            seeds[cluster] = static_cast<int32_t>(first + i);
+            event_associations[cluster] = static_cast<int32_t>(event);
+          }
+        }
+      }
+      if (alpaka::oncePerGrid(acc)) {
+        seeds.resize(static_cast<std::size_t>(event_cluster_offsets[batch_size]));
+        event_associations.resize(static_cast<std::size_t>(event_cluster_offsets[batch_size]));
+      }
+    }
+  };
+
+  // Narrows the extremes and the tile sizes of each event down to the region occupied by its
+  // points, with one block reducing each event. Periodic coordinates keep the extremes of the
+  // whole batch, since they define the period of the coordinate.
+  struct KernelComputeEventExtremes {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1 &&
+               std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> tiles,
+                                  PointsView<Ndim, TPointsData> points,
+                                  const std::size_t* event_offsets,
+                                  std::size_t batch_size,
+                                  TData min_tile_size) const {
+      auto& extremes =
+          alpaka::declareSharedVar<internal::CoordinateExtremes<Ndim, TData>, __COUNTER__>(acc);
+
+      for (auto event : alpaka::independentGroups(acc, batch_size)) {
+        const auto first = event_offsets[event];
+        const auto event_size = event_offsets[event + 1] - first;
+
+        if (alpaka::oncePerBlock(acc)) {
+          for (auto dim = 0u; dim != Ndim; ++dim) {
+            extremes.min(dim) = std::numeric_limits<TData>::max();
+            extremes.max(dim) = std::numeric_limits<TData>::lowest();
+          }
+        }
+        alpaka::syncBlockThreads(acc);
+
+        internal::CoordinateExtremes<Ndim, TData> thread_extremes;
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          thread_extremes.min(dim) = std::numeric_limits<TData>::max();
+          thread_extremes.max(dim) = std::numeric_limits<TData>::lowest();
+        }
+        for (auto i : alpaka::independentGroupElements(acc, event_size)) {
+          for (auto dim = 0u; dim != Ndim; ++dim) {
+            const auto coord = points.coords()[dim][first + i];
+            thread_extremes.min(dim) = math::min(thread_extremes.min(dim), coord);
+            thread_extremes.max(dim) = math::max(thread_extremes.max(dim), coord);
+          }
+        }
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          alpaka::atomicMin(acc, &extremes.min(dim), thread_extremes.min(dim));
+          alpaka::atomicMax(acc, &extremes.max(dim), thread_extremes.max(dim));
+        }
+        alpaka::syncBlockThreads(acc);
+
+        if (alpaka::oncePerBlock(acc) && event_size > 0) {
+          for (auto dim = 0u; dim != Ndim; ++dim) {
+            if (tiles.wrapped()[dim])
+              continue;
+
+            tiles.minMax()[event].min(dim) = extremes.min(dim);
+            tiles.minMax()[event].max(dim) = extremes.max(dim);
+            // an event with all its points aligned along a coordinate still needs tiles with a
+            // finite size along it
+            const auto tile_size = math::max(extremes.range(dim) / tiles.nperdim, min_tile_size);
+            tiles.tileSize()[event * Ndim + dim] = (tile_size > TData{0}) ? tile_size : TData{1};
+          }
+        }
+        // the shared extremes are reused by the next event of the block
+        alpaka::syncBlockThreads(acc);
+      }
+    }
+  };
+
+  struct KernelCopyEventOffsets {
+    template <typename TAcc>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  const uint32_t* offsets,
+                                  std::size_t* event_offsets,
+                                  std::size_t size) const {
+      for (auto i : alpaka::uniformElements(acc, size)) {
+        event_offsets[i] = offsets[i];
+      }
+    }
+  };
+
   struct KernelCalculateLocalDensityBatched {
     template <typename TAcc,
               std::size_t Ndim,
@@ -32,54 +310,55 @@ namespace clue::detail {
               concepts::convolutional_kernel KernelType,
               concepts::distance_metric<Ndim> DistanceMetric,
               std::floating_point TPointsData = TData>
-      requires(alpaka::Dim<TAcc>::value == 2 &&
+      requires(alpaka::Dim<TAcc>::value == 1 &&
                std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
     ALPAKA_FN_ACC void operator()(const TAcc& acc,
                                   internal::TilesView<Ndim, TData> dev_tiles,
                                   PointsView<Ndim, TPointsData> dev_points,
                                   const KernelType& kernel,
-                                  TData density_radius,
+                                  EventParametersView<TData> parameters,
                                   DistanceMetric metric,
                                   const auto* event_offsets,
-                                  std::size_t max_event_size,
-                                  std::size_t /* blocks_per_event */) const {
-      for (auto event : alpaka::uniformElementsAlong<0u>(acc)) {
-        for (auto local_idx : alpaka::uniformElementsAlong<1u>(acc, max_event_size)) {
-          const auto global_idx = event_offsets[event] + local_idx;
-          if (global_idx < event_offsets[event + 1]) {
-            auto rho_i = TData{0};
-            auto coords_i = dev_points[global_idx];
-
-            clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
-            for (auto dim = 0u; dim != Ndim; ++dim) {
-              const auto sigma_i =
-                  dev_points.has_sigma(dim) ? dev_points.sigma(dim)[global_idx] : TData{0};
-              const auto box_radius =
-                  math::max(density_radius, density_radius * sigma_i * math::sqrt(TData{2}));
-              searchbox_extremes[dim] =
-                  clue::nostd::make_array(coords_i[dim] - box_radius, coords_i[dim] + box_radius);
-            }
+                                  std::size_t batch_size,
+                                  std::size_t n_points) const {
+      for (auto global_idx : alpaka::uniformElements(acc, n_points)) {
+        const auto event = find_event(event_offsets, batch_size, global_idx);
+        if (event < batch_size) {
+          const auto density_radius = parameters[event].density_radius;
+          auto rho_i = TData{0};
+          bool has_neighbours = false;
+          auto coords_i = dev_points[global_idx];
 
-            clue::SearchBoxBins<Ndim> searchbox_bins;
-            dev_tiles.searchBox(searchbox_extremes, searchbox_bins);
-
-            std::array<int32_t, Ndim> base_vec;
-            for_recursion<TAcc, Ndim, Ndim>(acc,
-                                            base_vec,
-                                            searchbox_bins,
-                                            dev_tiles,
-                                            dev_points,
-                                            kernel,
-                                            coords_i,
-                                            rho_i,
-                                            density_radius,
-                                            metric,
-                                            global_idx,
-                                            event);
-
-            assert(rho_i >= TData{0});
-            dev_points.rho()[global_idx] = rho_i;
+          clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
+          for (auto dim = 0u; dim != Ndim; ++dim) {
+            const auto sigma_i =
+                dev_points.has_sigma(dim) ? dev_points.sigma(dim)[global_idx] : TData{0};
+            const auto box_radius =
+                math::max(density_radius, density_radius * sigma_i * math::sqrt(TData{2}));
+            searchbox_extremes[dim] =
+                clue::nostd::make_array(coords_i[dim] - box_radius, coords_i[dim] + box_radius);
           }
+
+          clue::SearchBoxBins<Ndim> searchbox_bins;
+          dev_tiles.searchBox(searchbox_extremes, searchbox_bins, event);
+
+          std::array<int32_t, Ndim> base_vec;
+          for_recursion<TAcc, Ndim, Ndim>(acc,
+                                          base_vec,
+                                          searchbox_bins,
+                                          dev_tiles,
+                                          dev_points,
+                                          kernel,
+                                          coords_i,
+                                          rho_i,
+                                          has_neighbours,
+                                          density_radius,
+                                          metric,
+                                          global_idx,
+                                          event);
+
+          assert(rho_i >= TData{0});
+          dev_points.rho()[global_idx] = rho_i;
         }
       }
     }
@@ -91,68 +370,63 @@ namespace clue::detail {
               std::floating_point TData,
               concepts::distance_metric<Ndim> DistanceMetric,
               std::floating_point TPointsData = TData>
-      requires(alpaka::Dim<TAcc>::value == 2 &&
+      requires(alpaka::Dim<TAcc>::value == 1 &&
                std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
     ALPAKA_FN_ACC void operator()(const TAcc& acc,
                                   internal::TilesView<Ndim, TData> dev_tiles,
                                   PointsView<Ndim, TPointsData> dev_points,
-                                  TData outlier_distance,
-                                  TData seeding_distance,
-                                  TData min_density,
+                                  EventParametersView<TData> parameters,
                                   DistanceMetric metric,
-                                  std::size_t* seed_candidates,
                                   const auto* event_offsets,
-                                  std::size_t max_event_size,
-                                  std::size_t /* blocks_per_event */) const {
-      for (auto event : alpaka::uniformElementsAlong<0u>(acc)) {
-        for (auto local_idx : alpaka::uniformElementsAlong<1u>(acc, max_event_size)) {
-          const auto global_idx = event_offsets[event] + local_idx;
-          if (global_idx < event_offsets[event + 1]) {
-            auto delta_i = std::numeric_limits<TData>::max();
-            int nh_i = -1;
-            auto coords_i = dev_points[global_idx];
-            auto rho_i = dev_points.rho()[global_idx];
-            const auto density_uncertainty = dev_points.has_uncertainty()
-                                                 ? dev_points.density_uncertainty()[global_idx]
-                                                 : TData{1.};
-            const auto effective_min_density = min_density * density_uncertainty;
-
-            clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
-            for (auto dim = 0u; dim != Ndim; ++dim) {
-              const auto sigma_i =
-                  dev_points.has_sigma(dim) ? dev_points.sigma(dim)[global_idx] : TData{0};
-              const auto box_radius =
-                  math::max(outlier_distance, outlier_distance * sigma_i * math::sqrt(TData{2}));
-              searchbox_extremes[dim] =
-                  clue::nostd::make_array(coords_i[dim] - box_radius, coords_i[dim] + box_radius);
-            }
+                                  std::size_t batch_size,
+                                  std::size_t n_points) const {
+      for (auto global_idx : alpaka::uniformElements(acc, n_points)) {
+        const auto event = find_event(event_offsets, batch_size, global_idx);
+        if (event < batch_size) {
+          const auto event_parameters = parameters[event];
+          const auto outlier_distance = event_parameters.outlier_distance;
+          const auto seeding_distance = event_parameters.seeding_distance;
+          auto delta_i = std::numeric_limits<TData>::max();
+          int nh_i = -1;
+          auto coords_i = dev_points[global_idx];
+          auto rho_i = dev_points.rho()[global_idx];
+          const auto density_uncertainty = dev_points.has_uncertainty()
+                                               ? dev_points.density_uncertainty()[global_idx]
+                                               : TData{1.};
+          const auto effective_min_density = event_parameters.min_density * density_uncertainty;
 
-            clue::SearchBoxBins<Ndim> searchbox_bins;
-            dev_tiles.searchBox(searchbox_extremes, searchbox_bins);
-
-            std::array<int32_t, Ndim> base_vec{};
-            for_recursion_nearest_higher<TAcc, Ndim, Ndim>(acc,
-                                                           base_vec,
-                                                           searchbox_bins,
-                                                           dev_tiles,
-                                                           dev_points,
-                                                           coords_i,
-                                                           rho_i,
-                                                           delta_i,
-                                                           nh_i,
-                                                           outlier_distance,
-                                                           seeding_distance,
-                                                           effective_min_density,
-                                                           metric,
-                                                           global_idx,
-                                                           event);
-
-            assert(nh_i == -1 || delta_i <= outlier_distance);
-            dev_points.nearest_higher()[global_idx] = nh_i;
-            if (nh_i == -1) {
-              alpaka::atomicAdd(acc, seed_candidates, std::size_t{1});
-            }
+          clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
+          for (auto dim = 0u; dim != Ndim; ++dim) {
+            const auto sigma_i =
+                dev_points.has_sigma(dim) ? dev_points.sigma(dim)[global_idx] : TData{0};
+            const auto box_radius =
+                math::max(outlier_distance, outlier_distance * sigma_i * math::sqrt(TData{2}));
+            searchbox_extremes[dim] =
+                clue::nostd::make_array(coords_i[dim] - box_radius, coords_i[dim] + box_radius);
           }
+
+          clue::SearchBoxBins<Ndim> searchbox_bins;
+          dev_tiles.searchBox(searchbox_extremes, searchbox_bins, event);
+
+          std::array<int32_t, Ndim> base_vec{};
+          for_recursion_nearest_higher<TAcc, Ndim, Ndim>(acc,
+                                                         base_vec,
+                                                         searchbox_bins,
+                                                         dev_tiles,
+                                                         dev_points,
+                                                         coords_i,
+                                                         rho_i,
+                                                         delta_i,
+                                                         nh_i,
+                                                         outlier_distance,
+                                                         seeding_distance,
+                                                         effective_min_density,
+                                                         metric,
+                                                         global_idx,
+                                                         event);
+
+          assert(nh_i == -1 || delta_i <= outlier_distance);
+          dev_points.nearest_higher()[global_idx] = nh_i;
         }
       }
     }
@@ -160,33 +434,33 @@ namespace clue::detail {
 
   struct KernelFindClustersBatched {
     template <typename TAcc, std::size_t Ndim, std::floating_point TData>
-      requires(alpaka::Dim<TAcc>::value == 2)
+      requires(alpaka::Dim<TAcc>::value == 1)
     ALPAKA_FN_ACC void operator()(const TAcc& acc,
                                   clue::internal::SeedArrayView seeds,
                                   PointsView<Ndim, TData> dev_points,
-                                  std::remove_cv_t<TData> min_density,
+                                  EventParametersView<std::remove_cv_t<TData>> parameters,
                                   clue::internal::DeviceVectorView event_associations,
                                   const auto* event_offsets,
-                                  std::size_t max_event_size) const {
-      for (const auto event : alpaka::uniformElementsAlong<0u>(acc)) {
-        for (const auto local_idx : alpaka::uniformElementsAlong<1u>(acc, max_event_size)) {
-          const auto global_idx = event_offsets[event] + local_idx;
-          if (global_idx < event_offsets[event + 1]) {
-            dev_points.cluster_index()[global_idx] = -1;
-            const auto nh = dev_points.nearest_higher()[global_idx];
-            const auto rho_i = dev_points.rho()[global_idx];
-            const auto density_uncertainty = dev_points.has_uncertainty()
-                                                 ? dev_points.density_uncertainty()[global_idx]
-                                                 : TData{1.};
-            const auto is_seed = (nh == -1) && (rho_i >= min_density * density_uncertainty);
-
-            if (is_seed) {
-              dev_points.is_seed()[global_idx] = 1;
-              const auto prev = seeds.push_back(acc, global_idx);
-              event_associations[prev] = event;
-            } else {
-              dev_points.is_seed()[global_idx] = 0;
-            }
+                                  std::size_t batch_size,
+                                  std::size_t n_points) const {
+      for (const auto global_idx : alpaka::uniformElements(acc, n_points)) {
+        const auto event = find_event(event_offsets, batch_size, global_idx);
+        if (event < batch_size) {
+          dev_points.cluster_index()[global_idx] = -1;
+          const auto nh = dev_points.nearest_higher()[global_idx];
+          const auto rho_i = dev_points.rho()[global_idx];
+          const auto density_uncertainty = dev_points.has_uncertainty()
+                                               ? dev_points.density_uncertainty()[global_idx]
+                                               : TData{1.};
+          const auto is_seed =
+              (nh == -1) && (rho_i >= parameters[event].min_density * density_uncertainty);
+
+          if (is_seed) {
+            dev_points.is_seed()[global_idx] = 1;
+            const auto prev = seeds.push_back(acc, global_idx);
+            event_associations[prev] = event;
+          } else {
+            dev_points.is_seed()[global_idx] = 0;
           }
         }
       }
@@ -210,6 +484,76 @@ namespace clue::detail {
     }
   };
 
+  // Computes the offsets of the events of a batch from their sizes on the host and copies them to
+  // the device
+  template <concepts::queue TQueue>
+  inline auto make_event_offsets(TQueue& queue, std::span<const uint32_t> event_sizes) {
+    const auto batch_size = event_sizes.size();
+    auto h_event_offsets = clue::make_host_buffer<std::size_t[]>(batch_size + 1);
+    h_event_offsets[0] = 0;
+    std::inclusive_scan(event_sizes.begin(), event_sizes.end(), h_event_offsets.data() + 1);
+    auto event_offsets = clue::make_device_buffer<std::size_t[]>(queue, batch_size + 1);
+    alpaka::memcpy(queue, event_offsets, h_event_offsets);
+    alpaka::wait(queue);
+    return event_offsets;
+  }
+
+  // Computes the offsets of the events of a batch from their sizes, both residing on the device.
+  // The offsets are computed with a scan on the device, without synchronizing the queue.
+  template <concepts::queue TQueue>
+  inline auto computeEventOffsets(TQueue& queue, std::span<const uint32_t> event_sizes) {
+    const auto batch_size = event_sizes.size();
+    auto event_offsets = clue::make_device_buffer<std::size_t[]>(queue, batch_size + 1);
+    alpaka::memset(queue, event_offsets, 0u, 1u);
+    internal::algorithm::inclusive_scan(queue,
+                                        event_sizes.data(),
+                                        event_sizes.data() + batch_size,
+                                        event_offsets.data() + 1);
+    return event_offsets;
+  }
+
+  // Copies the offsets of the events of a batch residing on the device into the offsets used
+  // internally by the batched clustering, without synchronizing the queue
+  template <concepts::accelerator TAcc, concepts::queue TQueue>
+    requires(alpaka::Dim<TAcc>::value == 1)
+  inline auto copyEventOffsets(TQueue& queue,
+                               std::size_t block_size,
+                               std::span<const uint32_t> offsets) {
+    auto event_offsets = clue::make_device_buffer<std::size_t[]>(queue, offsets.size());
+    const auto grid_size = nostd::ceil_div(offsets.size(), block_size);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(grid_size, block_size),
+                         KernelCopyEventOffsets{},
+                         offsets.data(),
+                         event_offsets.data(),
+                         offsets.size());
+    return event_offsets;
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1 &&
+             std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+  inline void computeEventExtremes(TQueue& queue,
+                                   std::size_t block_size,
+                                   internal::TilesView<Ndim, TData>& tiles,
+                                   PointsView<Ndim, TPointsData>& points,
+                                   const auto& event_offsets,
+                                   TData min_tile_size) {
+    const auto batch_size = alpaka::getExtents(event_offsets)[0] - 1;
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(batch_size, block_size),
+                         KernelComputeEventExtremes{},
+                         tiles,
+                         points,
+                         event_offsets.data(),
+                         batch_size,
+                         min_tile_size);
+  }
+
   template <concepts::accelerator TAcc,
             concepts::queue TQueue,
             std::size_t Ndim,
@@ -217,32 +561,31 @@ namespace clue::detail {
             concepts::convolutional_kernel KernelType,
             concepts::distance_metric<Ndim> DistanceMetric,
             std::floating_point TPointsData = TData>
-    requires(alpaka::Dim<TAcc>::value == 2 &&
+    requires(alpaka::Dim<TAcc>::value == 1 &&
              std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
   inline void computeLocalDensityBatched(TQueue& queue,
                                          internal::TilesView<Ndim, TData>& tiles,
                                          PointsView<Ndim, TPointsData>& dev_points,
                                          KernelType&& kernel,
-                                         TData density_radius,
+                                         EventParametersView<TData> parameters,
                                          const DistanceMetric& metric,
                                          const auto& event_offsets,
-                                         std::size_t max_event_size,
                                          std::size_t block_size) {
-    const auto blocks_per_event = nostd::ceil_div(max_event_size, block_size);
     const auto batch_size = alpaka::getExtents(event_offsets)[0] - 1;
+    const auto n_points = static_cast<std::size_t>(dev_points.size());
     const auto work_division =
-        make_workdiv<internal::Acc2D>({batch_size, blocks_per_event}, {1, block_size});
-    alpaka::exec<TAcc>(queue,
-                       work_division,
-                       KernelCalculateLocalDensityBatched{},
-                       tiles,
-                       dev_points,
-                       std::forward<KernelType>(kernel),
-                       density_radius,
-                       metric,
-                       event_offsets.data(),
-                       max_event_size,
-                       blocks_per_event);
+        make_workdiv<TAcc>(nostd::ceil_div(n_points, block_size), block_size);
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelCalculateLocalDensityBatched{},
+                         tiles,
+                         dev_points,
+                         std::forward<KernelType>(kernel),
+                         parameters,
+                         metric,
+                         event_offsets.data(),
+                         batch_size,
+                         n_points);
   }
 
   template <concepts::accelerator TAcc,
@@ -251,41 +594,96 @@ namespace clue::detail {
             std::floating_point TData,
             concepts::distance_metric<Ndim> DistanceMetric,
             std::floating_point TPointsData = TData>
-    requires(alpaka::Dim<TAcc>::value == 2 &&
+    requires(alpaka::Dim<TAcc>::value == 1 &&
              std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
   inline void computeNearestHighersBatched(TQueue& queue,
                                            internal::TilesView<Ndim, TData>& tiles,
                                            PointsView<Ndim, TPointsData>& dev_points,
-                                           TData outlier_distance,
-                                           TData seeding_distance,
-                                           TData min_density,
+                                           EventParametersView<TData> parameters,
                                            const DistanceMetric& metric,
-                                           std::size_t& seed_candidates,
                                            const auto& event_offsets,
-                                           std::size_t max_event_size,
                                            std::size_t block_size) {
-    auto d_seed_candidates = clue::make_device_buffer<std::size_t>(queue);
-    alpaka::memset(queue, d_seed_candidates, 0u);
-
-    const auto blocks_per_event = nostd::ceil_div(max_event_size, block_size);
     const auto batch_size = alpaka::getExtents(event_offsets)[0] - 1;
+    const auto n_points = static_cast<std::size_t>(dev_points.size());
     const auto work_division =
-        make_workdiv<internal::Acc2D>({batch_size, blocks_per_event}, {1, block_size});
-    alpaka::exec<TAcc>(queue,
-                       work_division,
-                       KernelCalculateNearestHigherBatched{},
-                       tiles,
-                       dev_points,
-                       outlier_distance,
-                       seeding_distance,
-                       min_density,
-                       metric,
-                       d_seed_candidates.data(),
-                       event_offsets.data(),
-                       max_event_size,
-                       blocks_per_event);
-    alpaka::memcpy(queue, clue::make_host_view(seed_candidates), d_seed_candidates);
+        make_workdiv<TAcc>(nostd::ceil_div(n_points, block_size), block_size);
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelCalculateNearestHigherBatched{},
+                         tiles,
+                         dev_points,
+                         parameters,
+                         metric,
+                         event_offsets.data(),
+                         batch_size,
+                         n_points);
+  }
+
+  // Runs the clustering of each event in a single block and returns the total number of seeds.
+  // event_cluster_offsets is filled with the offsets of the cluster indexes of each event.
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel KernelType,
+            concepts::distance_metric<Ndim> DistanceMetric>
+    requires(alpaka::Dim<TAcc>::value == 1)
+  inline std::size_t clusterEventsPerBlock(TQueue& queue,
+                                           std::size_t block_size,
+                                           PointsView<Ndim, TData>& points,
+                                           KernelType&& kernel,
+                                           EventParametersView<std::remove_cv_t<TData>> parameters,
+                                           const DistanceMetric& metric,
+                                           const auto& event_offsets,
+                                           auto& event_cluster_offsets) {
+    const auto batch_size = alpaka::getExtents(event_offsets)[0] - 1;
+    alpaka::memset(queue, event_cluster_offsets, 0);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(batch_size, block_size),
+                         KernelClusterEventsPerBlock{},
+                         points,
+                         std::forward<KernelType>(kernel),
+                         parameters,
+                         metric,
+                         event_offsets.data(),
+                         batch_size,
+                         event_cluster_offsets.data());
+    internal::algorithm::inclusive_scan(queue,
+                                        event_cluster_offsets.data(),
+                                        event_cluster_offsets.data() + batch_size + 1,
+                                        event_cluster_offsets.data());
+
+    auto n_seeds = int32_t{0};
+    alpaka::memcpy(queue,
+                   clue::make_host_view(n_seeds),
+                   clue::make_device_view(
+                       alpaka::getDev(queue), event_cluster_offsets.data() + batch_size, 1u));
     alpaka::wait(queue);
+    return static_cast<std::size_t>(n_seeds);
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData>
+    requires(alpaka::Dim<TAcc>::value == 1)
+  inline void offsetEventClusters(TQueue& queue,
+                                  std::size_t block_size,
+                                  PointsView<Ndim, TData>& points,
+                                  clue::internal::SeedArray<>& seeds,
+                                  clue::internal::DeviceVector<>& event_associations,
+                                  const auto& event_offsets,
+                                  const auto& event_cluster_offsets) {
+    const auto batch_size = alpaka::getExtents(event_offsets)[0] - 1;
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(batch_size, block_size),
+                         KernelOffsetEventClusters{},
+                         points,
+                         seeds.view(),
+                         event_associations.view(),
+                         event_offsets.data(),
+                         event_cluster_offsets.data(),
+                         batch_size);
   }
 
   template <concepts::accelerator TAcc, concepts::queue TQueue>
@@ -312,15 +710,15 @@ namespace clue::detail {
     const auto grid_size = clue::divide_up_by(num_seeds, block_size);
     const auto work_division = clue::make_workdiv<internal::Acc>(grid_size, block_size);
 
-    alpaka::exec<TAcc>(queue,
-                       work_division,
-                       KernelReorderSeeds{},
-                       seeds.view(),
-                       batch_association.view(),
-                       batches_to_seeds_indexes,
-                       seeds_reordered.view(),
-                       batches_reordered.view(),
-                       num_seeds);
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelReorderSeeds{},
+                         seeds.view(),
+                         batch_association.view(),
+                         batches_to_seeds_indexes,
+                         seeds_reordered.view(),
+                         batches_reordered.view(),
+                         num_seeds);
 
     alpaka::memcpy(
         queue,
@@ -339,28 +737,28 @@ namespace clue::detail {
             concepts::queue TQueue,
             std::size_t Ndim,
             std::floating_point TData>
-    requires(alpaka::Dim<TAcc>::value == 2)
+    requires(alpaka::Dim<TAcc>::value == 1)
   inline void findClusterSeedsBatched(TQueue& queue,
                                       clue::internal::SeedArray<>& seeds,
                                       PointsView<Ndim, TData>& dev_points,
-                                      std::remove_cv_t<TData> min_density,
+                                      EventParametersView<std::remove_cv_t<TData>> parameters,
                                       const auto& event_offsets,
-                                      std::size_t max_event_size,
                                       const clue::internal::DeviceVectorView& event_associations,
                                       std::size_t block_size) {
-    const auto blocks_per_event = nostd::ceil_div(max_event_size, block_size);
     const auto batch_size = alpaka::getExtents(event_offsets)[0] - 1;
+    const auto n_points = static_cast<std::size_t>(dev_points.size());
     const auto work_division =
-        make_workdiv<internal::Acc2D>({batch_size, blocks_per_event}, {1, block_size});
-    alpaka::exec<TAcc>(queue,
-                       work_division,
-                       KernelFindClustersBatched{},
-                       seeds.view(),
-                       dev_points,
-                       min_density,
-                       event_associations,
-                       event_offsets.data(),
-                       max_event_size);
+        make_workdiv<TAcc>(nostd::ceil_div(n_points, block_size), block_size);
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelFindClustersBatched{},
+                         seeds.view(),
+                         dev_points,
+                         parameters,
+                         event_associations,
+                         event_offsets.data(),
+                         batch_size,
+                         n_points);
   }
 
 }  // namespace clue::detail
@@ -8,6 +8,7 @@
 #include "CLUEstering/core/detail/ClusteringKernels.hpp"
 #include "CLUEstering/core/detail/ComputeTiles.hpp"
 #include "CLUEstering/core/detail/defines.hpp"
+#include "CLUEstering/core/detail/ExecutionScope.hpp"
 #include "CLUEstering/core/detail/SetupSeeds.hpp"
 #include "CLUEstering/core/detail/SetupTiles.hpp"
 #include "CLUEstering/data_structures/PointsHost.hpp"
@@ -18,6 +19,7 @@
 #include "CLUEstering/utils/get_clusters.hpp"
 
 #include <alpaka/alpaka.hpp>
+#include <algorithm>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
@@ -26,6 +28,7 @@
 #include <ranges>
 #include <span>
 #include <stdexcept>
+#include <utility>
 
 namespace clue {
 
@@ -38,7 +41,17 @@ namespace clue {
         m_seeding_distance{seeding_distance.value_or(density_radius)},
         m_min_density{min_density},
         m_outlier_distance{outlier_distance.value_or(density_radius)},
-        m_wrappedCoordinates{} {
+        m_wrappedCoordinates{},
+        m_sortedTiles{false},
+        m_separateNearestHigherTiles{false},
+        m_pairwiseDensity{false},
+        m_bruteForceThreshold{0},
+        m_blockPerEvent{true},
+        m_executionResources{},
+        m_filledTiles{false},
+        m_clusteredCoords{nullptr},
+        m_neighbourLists{false},
+        m_neighbourListsMaxBytes{std::size_t{1} << 28} {
     if (m_density_radius <= static_cast<value_type>(0.) ||
         m_min_density < static_cast<value_type>(0.) ||
         m_outlier_distance <= static_cast<value_type>(0.) ||
@@ -58,7 +71,17 @@ namespace clue {
         m_seeding_distance{seeding_distance.value_or(density_radius)},
         m_min_density{min_density},
         m_outlier_distance{outlier_distance.value_or(density_radius)},
-        m_wrappedCoordinates{} {
+        m_wrappedCoordinates{},
+        m_sortedTiles{false},
+        m_separateNearestHigherTiles{false},
+        m_pairwiseDensity{false},
+        m_bruteForceThreshold{0},
+        m_blockPerEvent{true},
+        m_executionResources{},
+        m_filledTiles{false},
+        m_clusteredCoords{nullptr},
+        m_neighbourLists{false},
+        m_neighbourListsMaxBytes{std::size_t{1} << 28} {
     if (m_density_radius <= static_cast<value_type>(0.) ||
         m_min_density < static_cast<value_type>(0.) ||
         m_outlier_distance <= static_cast<value_type>(0.) ||
@@ -145,7 +168,10 @@ namespace clue {
       clue::PointsDevice<Ndim, InputType>& dev_points,
       const DistanceMetric& metric,
       const Kernel& kernel) {
-    detail::setup_tiles(queue, dev_points, m_tiles, 128, m_wrappedCoordinates);
+    if (!use_brute_force(dev_points.size())) {
+      detail::setup_tiles(queue, dev_points, m_tiles, 128, m_wrappedCoordinates);
+      setup_nearest_higher_tiles(queue, dev_points);
+    }
     make_clusters_impl(dev_points, metric, kernel, queue);
     alpaka::wait(queue);
   }
@@ -161,9 +187,90 @@ namespace clue {
       std::span<const uint32_t> batch_item_sizes,
       const DistanceMetric& metric,
       const Kernel& kernel) {
+    const auto block_per_event = use_block_per_event<value_type>(batch_item_sizes);
+    setup_batch(queue, h_points, dev_points, batch_item_sizes.size(), block_per_event);
+    auto d_event_offsets = detail::make_event_offsets(queue, batch_item_sizes);
+    make_clusters_batched(
+        dev_points, d_event_offsets, block_per_event, nullptr, metric, kernel, queue);
+    clue::copyToHost(queue, h_points, dev_points);
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void Clusterer<Ndim, DataType>::make_clusters(
+      Queue& queue,
+      clue::PointsDevice<Ndim, InputType>& dev_points,
+      std::span<const uint32_t> batch_item_sizes,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
+    const auto block_per_event = use_block_per_event<InputType>(batch_item_sizes);
+    setup_batch(queue, dev_points, batch_item_sizes.size(), block_per_event);
+    auto d_event_offsets = detail::make_event_offsets(queue, batch_item_sizes);
+    make_clusters_batched(
+        dev_points, d_event_offsets, block_per_event, nullptr, metric, kernel, queue);
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void Clusterer<Ndim, DataType>::make_clusters(
+      Queue& queue,
+      clue::PointsDevice<Ndim, InputType>& dev_points,
+      DeviceEventSizes event_sizes,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
+    setup_batch(queue, dev_points, event_sizes.sizes.size(), false);
+    auto d_event_offsets = detail::computeEventOffsets(queue, event_sizes.sizes);
+    make_clusters_batched(dev_points, d_event_offsets, false, nullptr, metric, kernel, queue);
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void Clusterer<Ndim, DataType>::make_clusters(
+      Queue& queue,
+      clue::PointsDevice<Ndim, InputType>& dev_points,
+      DeviceEventOffsets event_offsets,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
+    if (event_offsets.offsets.empty()) {
+      throw std::invalid_argument(
+          "The offsets of the events must contain at least the offset of the first event");
+    }
+    setup_batch(queue, dev_points, event_offsets.offsets.size() - 1, false);
+    auto d_event_offsets =
+        detail::copyEventOffsets<internal::Acc>(queue, 256, event_offsets.offsets);
+    make_clusters_batched(dev_points, d_event_offsets, false, nullptr, metric, kernel, queue);
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void Clusterer<Ndim, DataType>::make_clusters(
+      Queue& queue,
+      clue::PointsHost<Ndim, InputType>& h_points,
+      clue::PointsDevice<Ndim, value_type>& dev_points,
+      std::span<const uint32_t> batch_item_sizes,
+      std::span<const EventParameters<value_type>> event_parameters,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
     const auto batch_size = batch_item_sizes.size();
-    setup_batch(queue, h_points, dev_points, batch_size);
-    make_clusters_batched(dev_points, batch_item_sizes, metric, kernel, queue);
+    auto d_event_parameters = make_event_parameters(queue, event_parameters, batch_size);
+    const auto block_per_event = use_block_per_event<value_type>(batch_item_sizes);
+    setup_batch(queue, h_points, dev_points, batch_size, block_per_event);
+    auto d_event_offsets = detail::make_event_offsets(queue, batch_item_sizes);
+    make_clusters_batched(dev_points,
+                          d_event_offsets,
+                          block_per_event,
+                          d_event_parameters.data(),
+                          metric,
+                          kernel,
+                          queue);
     clue::copyToHost(queue, h_points, dev_points);
   }
 
@@ -175,11 +282,223 @@ namespace clue {
       Queue& queue,
       clue::PointsDevice<Ndim, InputType>& dev_points,
       std::span<const uint32_t> batch_item_sizes,
+      std::span<const EventParameters<value_type>> event_parameters,
       const DistanceMetric& metric,
       const Kernel& kernel) {
     const auto batch_size = batch_item_sizes.size();
-    setup_batch(queue, dev_points, batch_size);
-    make_clusters_batched(dev_points, batch_item_sizes, metric, kernel, queue);
+    auto d_event_parameters = make_event_parameters(queue, event_parameters, batch_size);
+    const auto block_per_event = use_block_per_event<InputType>(batch_item_sizes);
+    setup_batch(queue, dev_points, batch_size, block_per_event);
+    auto d_event_offsets = detail::make_event_offsets(queue, batch_item_sizes);
+    make_clusters_batched(dev_points,
+                          d_event_offsets,
+                          block_per_event,
+                          d_event_parameters.data(),
+                          metric,
+                          kernel,
+                          queue);
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void Clusterer<Ndim, DataType>::make_clusters(
+      Queue& queue,
+      clue::PointsDevice<Ndim, InputType>& dev_points,
+      DeviceEventSizes event_sizes,
+      DeviceEventParameters<value_type> event_parameters,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
+    const auto batch_size = event_sizes.sizes.size();
+    if (event_parameters.parameters.size() != batch_size) {
+      throw std::invalid_argument(
+          "The number of event parameters must match the number of events in the batch");
+    }
+    setup_batch(queue, dev_points, batch_size, false);
+    auto d_event_offsets = detail::computeEventOffsets(queue, event_sizes.sizes);
+    make_clusters_batched(dev_points,
+                          d_event_offsets,
+                          false,
+                          event_parameters.parameters.data(),
+                          metric,
+                          kernel,
+                          queue);
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void Clusterer<Ndim, DataType>::make_clusters(
+      Queue& queue,
+      clue::PointsDevice<Ndim, InputType>& dev_points,
+      DeviceEventOffsets event_offsets,
+      DeviceEventParameters<value_type> event_parameters,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
+    if (event_offsets.offsets.empty()) {
+      throw std::invalid_argument(
+          "The offsets of the events must contain at least the offset of the first event");
+    }
+    const auto batch_size = event_offsets.offsets.size() - 1;
+    if (event_parameters.parameters.size() != batch_size) {
+      throw std::invalid_argument(
+          "The number of event parameters must match the number of events in the batch");
+    }
+    setup_batch(queue, dev_points, batch_size, false);
+    auto d_event_offsets =
+        detail::copyEventOffsets<internal::Acc>(queue, 256, event_offsets.offsets);
+    make_clusters_batched(dev_points,
+                          d_event_offsets,
+                          false,
+                          event_parameters.parameters.data(),
+                          metric,
+                          kernel,
+                          queue);
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline std::size_t Clusterer<Ndim, DataType>::update_positions(
+      Queue& queue,
+      clue::PointsHost<Ndim, InputType>& h_points,
+      clue::PointsDevice<Ndim, value_type>& dev_points,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
+    if (h_points.size() != dev_points.size()) {
+      throw std::invalid_argument("The host and device points must have the same size");
+    }
+    clue::copyToDevice(queue, dev_points, h_points);
+    const auto n_moved = update_positions(queue, dev_points, metric, kernel);
+    clue::copyToHost(queue, h_points, dev_points);
+    internal::points_interface<std::remove_cvref_t<decltype(h_points)>>::mark_clustered(h_points);
+    alpaka::wait(queue);
+    return n_moved;
+  }
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline std::size_t Clusterer<Ndim, DataType>::update_positions(
+      Queue& queue,
+      clue::PointsDevice<Ndim, InputType>& dev_points,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
+    if (const auto n_moved = update_tiles(queue, dev_points)) {
+      make_clusters_impl(dev_points, metric, kernel, queue, true);
+      return *n_moved;
+    }
+    make_clusters(queue, dev_points, metric, kernel);
+    return static_cast<std::size_t>(dev_points.size());
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline bool Clusterer<Ndim, DataType>::recluster(Queue& queue,
+                                                   clue::PointsHost<Ndim, InputType>& h_points,
+                                                   clue::PointsDevice<Ndim, value_type>& dev_points,
+                                                   const DistanceMetric& metric,
+                                                   const Kernel& kernel) {
+    if (h_points.size() != dev_points.size()) {
+      throw std::invalid_argument("The host and device points must have the same size");
+    }
+    if (!reusable_neighbour_lists(dev_points)) {
+      make_clusters(queue, h_points, dev_points, metric, kernel);
+      return false;
+    }
+    recluster(queue, dev_points, metric, kernel);
+    clue::copyToHost(queue, h_points, dev_points);
+    internal::points_interface<std::remove_cvref_t<decltype(h_points)>>::mark_clustered(h_points);
+    alpaka::wait(queue);
+    return true;
+  }
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline bool Clusterer<Ndim, DataType>::recluster(Queue& queue,
+                                                   clue::PointsDevice<Ndim, InputType>& dev_points,
+                                                   const DistanceMetric& metric,
+                                                   const Kernel& kernel) {
+    if (!reusable_neighbour_lists(dev_points)) {
+      make_clusters(queue, dev_points, metric, kernel);
+      return false;
+    }
+
+    detail::ExecutionScope execution_scope(queue, m_executionResources);
+    make_clusters_from_neighbours(dev_points, kernel, queue);
+    return true;
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+    requires concepts::detail::point_distance_metric<DistanceMetric, Ndim>
+  inline void Clusterer<Ndim, DataType>::assign(Queue& queue,
+                                                clue::PointsDevice<Ndim, value_type>& reference,
+                                                clue::PointsHost<Ndim, InputType>& h_points,
+                                                const DistanceMetric& metric,
+                                                const Kernel& kernel) {
+    auto d_points = clue::PointsDevice<Ndim, value_type>(queue, h_points.size());
+    clue::copyToDevice(queue, d_points, h_points);
+    assign(queue, reference, d_points, metric, kernel);
+    clue::copyToHost(queue, h_points, d_points);
+    internal::points_interface<std::remove_cvref_t<decltype(h_points)>>::mark_clustered(h_points);
+    alpaka::wait(queue);
+  }
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+    requires concepts::detail::point_distance_metric<DistanceMetric, Ndim>
+  inline void Clusterer<Ndim, DataType>::assign(Queue& queue,
+                                                clue::PointsDevice<Ndim, InputType>& reference,
+                                                clue::PointsDevice<Ndim, InputType>& dev_points,
+                                                const DistanceMetric& metric,
+                                                const Kernel& kernel) {
+    if (!reference.clustered()) {
+      throw std::runtime_error(
+          "The reference points have not been clustered. Please run make_clusters first.");
+    }
+    detail::ExecutionScope execution_scope(queue, m_executionResources);
+    constexpr std::size_t block_size = 256;
+
+    // the tiles are reused when they hold the reference points, otherwise, as after clustering
+    // few points without them or clustering other points, they are filled again with them
+    const bool reuse_tiles = m_filledTiles && m_clusteredCoords == reference.view().m_coords[0] &&
+                             m_tiles->view().npoints == reference.size();
+    if (!reuse_tiles) {
+      detail::setup_tiles(queue, reference, m_tiles, 128, m_wrappedCoordinates);
+      m_tiles->template fill<internal::Acc>(queue, reference);
+      sort_tiles(queue, m_tiles.value(), reference);
+      detail::computeTileMaxDensity<internal::Acc>(
+          queue, block_size, m_tiles->view(), reference.view(), m_tiles->extents().keys);
+      m_filledTiles = false;
+    }
+    auto& nearest_higher_tiles = (reuse_tiles && m_separateNearestHigherTiles)
+                                     ? m_nearest_higher_tiles.value()
+                                     : m_tiles.value();
+    detail::assignPoints<internal::Acc>(queue,
+                                        block_size,
+                                        m_tiles->view(),
+                                        nearest_higher_tiles.view(),
+                                        reference.view(),
+                                        dev_points.view(),
+                                        kernel,
+                                        m_density_radius,
+                                        m_outlier_distance,
+                                        m_seeding_distance,
+                                        m_min_density,
+                                        metric);
+    alpaka::wait(queue);
+    internal::points_interface<std::remove_cvref_t<decltype(dev_points)>>::mark_clustered(
+        dev_points);
   }
 
   template <std::size_t Ndim, std::floating_point DataType>
@@ -187,11 +506,63 @@ namespace clue {
     requires std::integral<std::ranges::range_value_t<TRange>>
   inline void Clusterer<Ndim, DataType>::setWrappedCoordinates(const TRange& wrapped_coordinates) {
     std::ranges::copy(wrapped_coordinates | std::views::take(Ndim), m_wrappedCoordinates.begin());
+    m_filledTiles = false;
+    m_neighbours.reset();
   }
   template <std::size_t Ndim, std::floating_point DataType>
   template <std::integral... TArgs>
   inline void Clusterer<Ndim, DataType>::setWrappedCoordinates(TArgs... wrappedCoordinates) {
     m_wrappedCoordinates = {static_cast<uint8_t>(wrappedCoordinates)...};
+    m_filledTiles = false;
+    m_neighbours.reset();
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  inline void Clusterer<Ndim, DataType>::setSortedTiles(bool sorted_tiles) {
+    m_sortedTiles = sorted_tiles;
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  inline void Clusterer<Ndim, DataType>::setSeparateNearestHigherTiles(bool separate_tiles) {
+    m_separateNearestHigherTiles = separate_tiles;
+    m_filledTiles = false;
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  inline void Clusterer<Ndim, DataType>::setPairwiseDensity(bool pairwise_density) {
+    m_pairwiseDensity = pairwise_density;
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  inline void Clusterer<Ndim, DataType>::setBruteForceThreshold(std::size_t threshold) {
+    m_bruteForceThreshold = threshold;
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType>
+  bool Clusterer<Ndim, DataType>::use_block_per_event(
+      std::span<const uint32_t> batch_item_sizes) const {
+    return m_blockPerEvent && std::ranges::all_of(batch_item_sizes, [](auto event_size) {
+             return event_size <= detail::max_block_event_size<Ndim, std::remove_cv_t<InputType>>;
+           });
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  inline void Clusterer<Ndim, DataType>::setBlockPerEvent(bool block_per_event) {
+    m_blockPerEvent = block_per_event;
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  inline void Clusterer<Ndim, DataType>::setNeighbourLists(bool neighbour_lists,
+                                                           std::size_t max_bytes) {
+    m_neighbourLists = neighbour_lists;
+    m_neighbourListsMaxBytes = max_bytes;
+    m_neighbours.reset();
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  inline void Clusterer<Ndim, DataType>::setExecutionResources(ExecutionResources resources) {
+    m_executionResources = std::move(resources);
   }
 
   template <std::size_t Ndim, std::floating_point DataType>
@@ -248,31 +619,239 @@ namespace clue {
   void Clusterer<Ndim, DataType>::make_clusters_impl(clue::PointsDevice<Ndim, InputType>& dev_points,
                                                      const DistanceMetric& metric,
                                                      const Kernel& kernel,
-                                                     Queue& queue) {
+                                                     Queue& queue,
+                                                     bool warm_start) {
+    detail::ExecutionScope execution_scope(queue, m_executionResources);
     constexpr std::size_t block_size = 256;
-    m_tiles->template fill<internal::Acc>(queue, dev_points);
+    if (use_brute_force(dev_points.size())) {
+      m_filledTiles = false;
+      m_neighbours.reset();
+      detail::computeBruteForceDensityAndNearestHighers<internal::Acc>(queue,
+                                                                       block_size,
+                                                                       dev_points.view(),
+                                                                       kernel,
+                                                                       m_density_radius,
+                                                                       m_outlier_distance,
+                                                                       m_seeding_distance,
+                                                                       m_min_density,
+                                                                       metric);
+      const Idx grid_size = nostd::ceil_div(dev_points.size(), block_size);
+      detail::findClusterSeeds<internal::Acc>(queue,
+                                              clue::make_workdiv<internal::Acc>(grid_size, block_size),
+                                              m_seeds,
+                                              m_seedPositions,
+                                              dev_points.view());
+      detail::followNearestHighers<internal::Acc>(queue, block_size, dev_points.view());
+
+      alpaka::wait(queue);
+      internal::points_interface<std::remove_cvref_t<decltype(dev_points)>>::mark_clustered(
+          dev_points);
+      return;
+    }
+
+    // on a warm start the tiles have already been updated with the points that moved
+    if (!warm_start)
+      m_tiles->template fill<internal::Acc>(queue, dev_points);
+    sort_tiles(queue, m_tiles.value(), dev_points);
+
+    m_neighbours.reset();
+    if (m_neighbourLists && build_neighbour_lists(queue, dev_points, metric)) {
+      make_clusters_from_neighbours(dev_points, kernel, queue);
+      // the maximum densities of the tiles, read when assigning new points, are not computed
+      m_filledTiles = false;
+      m_clusteredCoords = dev_points.view().m_coords[0];
+      return;
+    }
+    detail::computeTileExtremes<internal::Acc>(
+        queue, block_size, m_tiles->view(), dev_points.view(), m_tiles->extents().keys);
 
     const Idx grid_size = nostd::ceil_div(dev_points.size(), block_size);
     auto work_division = clue::make_workdiv<internal::Acc>(grid_size, block_size);
 
-    detail::computeLocalDensity<internal::Acc>(
-        queue, work_division, m_tiles->view(), dev_points.view(), kernel, m_density_radius, metric);
-    auto seed_candidates = std::size_t{0};
-    detail::computeNearestHighers<internal::Acc>(queue,
+    // the points without neighbours within the density radius can only be isolated outliers or
+    // seeds when they cannot find a nearest-higher farther away, so they are clustered by the
+    // density kernels and the following kernels iterate only over the remaining ones
+    const bool skip_isolated =
+        m_outlier_distance <= m_density_radius && m_seeding_distance <= m_density_radius;
+    auto active = clue::make_device_buffer<int32_t[]>(queue, skip_isolated ? dev_points.size() : 0);
+    auto* active_flags = skip_isolated ? active.data() : nullptr;
+
+    bool symmetric_density = false;
+    if constexpr (detail::use_symmetric_density_v<Kernel, DistanceMetric, Device>) {
+      symmetric_density =
+          m_pairwiseDensity &&
+          std::ranges::none_of(m_wrappedCoordinates, [](auto wrapped) { return wrapped; });
+      if (symmetric_density) {
+        detail::computeLocalDensitySymmetric<internal::Acc>(queue,
+                                                            block_size,
+                                                            m_tiles->view(),
+                                                            dev_points.view(),
+                                                            kernel,
+                                                            m_density_radius,
+                                                            metric,
+                                                            m_tiles->extents().keys,
+                                                            m_partialDensities,
+                                                            m_min_density,
+                                                            active_flags);
+      }
+    }
+    if (!symmetric_density) {
+      detail::computeLocalDensity<internal::Acc>(queue,
                                                  work_division,
                                                  m_tiles->view(),
                                                  dev_points.view(),
+                                                 kernel,
+                                                 m_density_radius,
+                                                 metric,
+                                                 m_min_density,
+                                                 active_flags);
+    }
+    auto active_points =
+        clue::make_device_buffer<int32_t[]>(queue, skip_isolated ? dev_points.size() : 0);
+    auto n_active = dev_points.size();
+    auto nearest_higher_work_division = work_division;
+    if (skip_isolated) {
+      n_active = detail::compactActivePoints<internal::Acc>(
+          queue, work_division, active_flags, active_points.data(), dev_points.size());
+      nearest_higher_work_division = clue::make_workdiv<internal::Acc>(
+          static_cast<Idx>(nostd::ceil_div(n_active, block_size)), block_size);
+    }
+    auto* active_list = skip_isolated ? active_points.data() : nullptr;
+
+    auto& nearest_higher_tiles =
+        m_separateNearestHigherTiles ? m_nearest_higher_tiles.value() : m_tiles.value();
+    if (m_separateNearestHigherTiles) {
+      if (!warm_start)
+        nearest_higher_tiles.template fill<internal::Acc>(queue, dev_points);
+      sort_tiles(queue, nearest_higher_tiles, dev_points);
+    }
+    detail::computeTileMaxDensity<internal::Acc>(queue,
+                                                 block_size,
+                                                 nearest_higher_tiles.view(),
+                                                 dev_points.view(),
+                                                 nearest_higher_tiles.extents().keys);
+    detail::computeNearestHighers<internal::Acc>(queue,
+                                                 nearest_higher_work_division,
+                                                 nearest_higher_tiles.view(),
+                                                 dev_points.view(),
                                                  m_outlier_distance,
                                                  m_seeding_distance,
                                                  m_min_density,
                                                  metric,
-                                                 seed_candidates);
-    detail::setup_seeds(queue, m_seeds, seed_candidates);
+                                                 active_list,
+                                                 n_active,
+                                                 warm_start);
     detail::findClusterSeeds<internal::Acc>(
-        queue, work_division, m_seeds.value(), dev_points.view(), m_min_density);
+        queue, work_division, m_seeds, m_seedPositions, dev_points.view());
 
-    detail::assignPointsToClusters<internal::Acc>(
-        queue, block_size, m_seeds.value(), dev_points.view());
+    detail::followNearestHighers<internal::Acc>(
+        queue, block_size, dev_points.view(), active_list, n_active);
+
+    alpaka::wait(queue);
+    internal::points_interface<std::remove_cvref_t<decltype(dev_points)>>::mark_clustered(
+        dev_points);
+    m_filledTiles = true;
+    m_clusteredCoords = dev_points.view().m_coords[0];
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType>
+  std::optional<std::size_t> Clusterer<Ndim, DataType>::update_tiles(
+      Queue& queue, clue::PointsDevice<Ndim, InputType>& dev_points) {
+    const auto n_points = dev_points.size();
+    if (!m_filledTiles || use_brute_force(n_points) || !dev_points.clustered() ||
+        m_clusteredCoords != dev_points.view().m_coords[0] || m_tiles->view().npoints != n_points) {
+      return std::nullopt;
+    }
+
+    const auto min_max = detail::compute_extremes<Ndim, InputType>(dev_points);
+    if (!detail::fits_tiles_grid(queue, *m_tiles, min_max) ||
+        (m_separateNearestHigherTiles &&
+         !detail::fits_tiles_grid(queue, *m_nearest_higher_tiles, min_max))) {
+      return std::nullopt;
+    }
+
+    const auto n_moved = m_tiles->template update<internal::Acc>(queue, dev_points);
+    if (m_separateNearestHigherTiles)
+      m_nearest_higher_tiles->template update<internal::Acc>(queue, dev_points);
+    return n_moved;
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType, concepts::distance_metric<Ndim> DistanceMetric>
+  bool Clusterer<Ndim, DataType>::build_neighbour_lists(
+      Queue& queue, clue::PointsDevice<Ndim, InputType>& dev_points, const DistanceMetric& metric) {
+    if constexpr (detail::supports_neighbour_lists_v<DistanceMetric>) {
+      const auto radius = std::max({m_density_radius, m_outlier_distance, m_seeding_distance});
+      m_neighbours = detail::buildNeighbourLists<internal::Acc>(queue,
+                                                                256,
+                                                                m_tiles->view(),
+                                                                dev_points.view(),
+                                                                radius,
+                                                                metric,
+                                                                m_neighbourListsMaxBytes);
+      return m_neighbours.has_value();
+    } else {
+      return false;
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType>
+  bool Clusterer<Ndim, DataType>::reusable_neighbour_lists(
+      const clue::PointsDevice<Ndim, InputType>& dev_points) const {
+    const auto radius = std::max({m_density_radius, m_outlier_distance, m_seeding_distance});
+    return m_neighbours.has_value() && m_clusteredCoords == dev_points.view().m_coords[0] &&
+           m_neighbours->n_points == static_cast<std::size_t>(dev_points.size()) &&
+           dev_points.clustered() && radius <= m_neighbours->radius;
+  }
+
+  template <std::size_t Ndim, std::floating_point DataType>
+  template <std::floating_point InputType, concepts::convolutional_kernel Kernel>
+  void Clusterer<Ndim, DataType>::make_clusters_from_neighbours(
+      clue::PointsDevice<Ndim, InputType>& dev_points, const Kernel& kernel, Queue& queue) {
+    constexpr std::size_t block_size = 256;
+    const Idx grid_size = nostd::ceil_div(dev_points.size(), block_size);
+    auto work_division = clue::make_workdiv<internal::Acc>(grid_size, block_size);
+
+    const bool skip_isolated =
+        m_outlier_distance <= m_density_radius && m_seeding_distance <= m_density_radius;
+    auto active = clue::make_device_buffer<int32_t[]>(queue, skip_isolated ? dev_points.size() : 0);
+    auto* active_flags = skip_isolated ? active.data() : nullptr;
+    detail::computeLocalDensityFromNeighbours<internal::Acc>(queue,
+                                                             work_division,
+                                                             *m_neighbours,
+                                                             dev_points.view(),
+                                                             kernel,
+                                                             m_density_radius,
+                                                             m_min_density,
+                                                             active_flags);
+
+    auto active_points =
+        clue::make_device_buffer<int32_t[]>(queue, skip_isolated ? dev_points.size() : 0);
+    auto n_active = dev_points.size();
+    auto nearest_higher_work_division = work_division;
+    if (skip_isolated) {
+      n_active = detail::compactActivePoints<internal::Acc>(
+          queue, work_division, active_flags, active_points.data(), dev_points.size());
+      nearest_higher_work_division = clue::make_workdiv<internal::Acc>(
+          static_cast<Idx>(nostd::ceil_div(n_active, block_size)), block_size);
+    }
+    auto* active_list = skip_isolated ? active_points.data() : nullptr;
+    detail::computeNearestHighersFromNeighbours<internal::Acc>(queue,
+                                                               nearest_higher_work_division,
+                                                               *m_neighbours,
+                                                               dev_points.view(),
+                                                               m_outlier_distance,
+                                                               m_seeding_distance,
+                                                               m_min_density,
+                                                               active_list,
+                                                               n_active);
+    detail::findClusterSeeds<internal::Acc>(
+        queue, work_division, m_seeds, m_seedPositions, dev_points.view());
+
+    detail::followNearestHighers<internal::Acc>(
+        queue, block_size, dev_points.view(), active_list, n_active);
 
     alpaka::wait(queue);
     internal::points_interface<std::remove_cvref_t<decltype(dev_points)>>::mark_clustered(
@@ -285,57 +864,101 @@ namespace clue {
             concepts::distance_metric<Ndim> DistanceMetric>
   void Clusterer<Ndim, DataType>::make_clusters_batched(
       clue::PointsDevice<Ndim, InputType>& dev_points,
-      std::span<const uint32_t> batch_item_sizes,
+      const clue::device_buffer<clue::Device, std::size_t[]>& d_event_offsets,
+      bool block_per_event,
+      const EventParameters<value_type>* event_parameters,
       const DistanceMetric& metric,
       const Kernel& kernel,
       Queue& queue) {
+    detail::ExecutionScope execution_scope(queue, m_executionResources);
+    m_filledTiles = false;
+    m_neighbours.reset();
     constexpr std::size_t block_size = 256;
-    const auto batch_size = batch_item_sizes.size();
-
-    const auto max_event_size = std::reduce(
-        batch_item_sizes.begin(), batch_item_sizes.end(), 0u, nostd::maximum<uint32_t>{});
-
-    auto event_offsets = clue::make_host_buffer<std::size_t[]>(batch_size + 1);
-    event_offsets[0] = 0;
-    std::inclusive_scan(batch_item_sizes.begin(), batch_item_sizes.end(), event_offsets.data() + 1);
-    auto d_event_offsets = clue::make_device_buffer<std::size_t[]>(queue, batch_size + 1);
-    alpaka::memcpy(queue, d_event_offsets, event_offsets);
-    alpaka::wait(queue);
-
-    m_tiles->template fill_batch<internal::Acc>(queue, dev_points, d_event_offsets, max_event_size);
+    const auto batch_size = alpaka::getExtents(d_event_offsets)[0] - 1;
+    // without per-event parameters every event uses the ones of the clusterer
+    const detail::EventParametersView<value_type> parameters{
+        event_parameters,
+        {m_density_radius, m_min_density, m_outlier_distance, m_seeding_distance}};
+
+    if (block_per_event) {
+      auto d_event_cluster_offsets = clue::make_device_buffer<int32_t[]>(queue, batch_size + 1);
+      const auto n_seeds = detail::clusterEventsPerBlock<internal::Acc>(queue,
+                                                                        block_size,
+                                                                        dev_points.view(),
+                                                                        kernel,
+                                                                        parameters,
+                                                                        metric,
+                                                                        d_event_offsets,
+                                                                        d_event_cluster_offsets);
+      detail::setup_seeds(queue, m_seeds, n_seeds);
+      m_event_associations = clue::internal::SeedArray<>(queue, n_seeds);
+      detail::offsetEventClusters<internal::Acc>(queue,
+                                                 block_size,
+                                                 dev_points.view(),
+                                                 m_seeds.value(),
+                                                 m_event_associations.value(),
+                                                 d_event_offsets,
+                                                 d_event_cluster_offsets);
+
+      alpaka::wait(queue);
+      internal::points_interface<std::remove_cvref_t<decltype(dev_points)>>::mark_clustered(
+          dev_points);
+      return;
+    }
 
-    detail::computeLocalDensityBatched<internal::Acc2D>(queue,
-                                                        m_tiles->view(),
+    detail::computeEventExtremes<internal::Acc>(
+        queue, block_size, m_tiles->view(), dev_points.view(), d_event_offsets, value_type{0});
+    m_tiles->template fill_batch<internal::Acc>(queue, dev_points, d_event_offsets);
+    sort_tiles(queue, m_tiles.value(), dev_points);
+    detail::computeTileExtremes<internal::Acc>(
+        queue, block_size, m_tiles->view(), dev_points.view(), m_tiles->extents().keys);
+
+    detail::computeLocalDensityBatched<internal::Acc>(queue,
+                                                      m_tiles->view(),
+                                                      dev_points.view(),
+                                                      kernel,
+                                                      parameters,
+                                                      metric,
+                                                      d_event_offsets,
+                                                      block_size);
+    auto& nearest_higher_tiles =
+        m_separateNearestHigherTiles ? m_nearest_higher_tiles.value() : m_tiles.value();
+    if (m_separateNearestHigherTiles) {
+      // the tiles of the nearest-higher search are not made smaller than the search radius
+      detail::computeEventExtremes<internal::Acc>(queue,
+                                                  block_size,
+                                                  nearest_higher_tiles.view(),
+                                                  dev_points.view(),
+                                                  d_event_offsets,
+                                                  m_outlier_distance);
+      nearest_higher_tiles.template fill_batch<internal::Acc>(queue, dev_points, d_event_offsets);
+      sort_tiles(queue, nearest_higher_tiles, dev_points);
+    }
+    detail::computeTileMaxDensity<internal::Acc>(queue,
+                                                 block_size,
+                                                 nearest_higher_tiles.view(),
+                                                 dev_points.view(),
+                                                 nearest_higher_tiles.extents().keys);
+    detail::computeNearestHighersBatched<internal::Acc>(queue,
+                                                        nearest_higher_tiles.view(),
                                                         dev_points.view(),
-                                                        kernel,
-                                                        m_density_radius,
+                                                        parameters,
                                                         metric,
                                                         d_event_offsets,
-                                                        max_event_size,
                                                         block_size);
-    auto seed_candidates = std::size_t{0};
-    detail::computeNearestHighersBatched<internal::Acc2D>(queue,
-                                                          m_tiles->view(),
-                                                          dev_points.view(),
-                                                          m_outlier_distance,
-                                                          m_seeding_distance,
-                                                          m_min_density,
-                                                          metric,
-                                                          seed_candidates,
-                                                          d_event_offsets,
-                                                          max_event_size,
-                                                          block_size);
-    detail::setup_seeds(queue, m_seeds, seed_candidates);
-    m_event_associations = clue::internal::SeedArray<>(queue, seed_candidates);
-
-    detail::findClusterSeedsBatched<internal::Acc2D>(queue,
-                                                     m_seeds.value(),
-                                                     dev_points.view(),
-                                                     m_min_density,
-                                                     d_event_offsets,
-                                                     max_event_size,
-                                                     m_event_associations->view(),
-                                                     block_size);
+    // the number of points bounds the number of seeds, so the seed arrays are sized without
+    // reading back the number of seed candidates
+    const auto n_points = static_cast<std::size_t>(dev_points.size());
+    detail::setup_seeds(queue, m_seeds, n_points);
+    detail::setup_seeds(queue, m_event_associations, n_points);
+
+    detail::findClusterSeedsBatched<internal::Acc>(queue,
+                                                   m_seeds.value(),
+                                                   dev_points.view(),
+                                                   parameters,
+                                                   d_event_offsets,
+                                                   m_event_associations->view(),
+                                                   block_size);
 
     detail::reorderSeedsBatchWise<internal::Acc>(
         queue, m_seeds.value(), m_event_associations.value());
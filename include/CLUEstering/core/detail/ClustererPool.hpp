@@ -0,0 +1,165 @@
+
+#pragma once
+
+#include "CLUEstering/core/ClustererPool.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/internal/alpaka/devices.hpp"
+
+#include <alpaka/alpaka.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace clue {
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline ClustererPool<Ndim, TData>::ClustererPool(std::span<const Device> devices,
+                                                   std::size_t n_workers,
+                                                   value_type density_radius,
+                                                   value_type min_density,
+                                                   std::optional<value_type> outlier_distance,
+                                                   std::optional<value_type> seeding_distance)
+      : m_workers{}, m_start{std::chrono::steady_clock::now()} {
+    if (devices.empty() || n_workers == 0) {
+      throw std::invalid_argument("The pool must have at least one device and one worker");
+    }
+    m_workers.reserve(n_workers);
+    for (auto i = 0u; i < n_workers; ++i) {
+      const auto device = i % devices.size();
+      m_workers.push_back(std::make_unique<Worker>(devices[device],
+                                                   device,
+                                                   density_radius,
+                                                   min_density,
+                                                   outlier_distance,
+                                                   seeding_distance));
+    }
+    // the threads are started only once all the workers are built, so that a failure in the
+    // construction of a worker doesn't leave threads running, and if starting one of them fails
+    // the ones already running are joined before the exception leaves the constructor
+    try {
+      for (auto& worker : m_workers)
+        worker->thread = std::thread([this, &worker = *worker] { run(worker); });
+    } catch (...) {
+      stop();
+      throw;
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline ClustererPool<Ndim, TData>::ClustererPool(std::size_t n_workers,
+                                                   value_type density_radius,
+                                                   value_type min_density,
+                                                   std::optional<value_type> outlier_distance,
+                                                   std::optional<value_type> seeding_distance)
+      : ClustererPool(devices<Platform>(),
+                      n_workers,
+                      density_radius,
+                      min_density,
+                      outlier_distance,
+                      seeding_distance) {}
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline ClustererPool<Ndim, TData>::~ClustererPool() {
+    stop();
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void ClustererPool<Ndim, TData>::stop() {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    for (auto& worker : m_workers) {
+      worker->ready.notify_one();
+      if (worker->thread.joinable())
+        worker->thread.join();
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void ClustererPool<Ndim, TData>::run(Worker& worker) {
+    std::unique_lock lock(m_mutex);
+    while (true) {
+      worker.ready.wait(lock, [&] { return m_stop || !worker.tasks.empty(); });
+      // the pending events are still clustered when the pool is stopped
+      if (worker.tasks.empty())
+        return;
+
+      auto task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+      lock.unlock();
+      task(worker);
+      lock.lock();
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  template <concepts::convolutional_kernel Kernel, concepts::distance_metric<Ndim> DistanceMetric>
+  inline std::future<void> ClustererPool<Ndim, TData>::submit(
+      PointsHost<Ndim, value_type>& points, const DistanceMetric& metric, const Kernel& kernel) {
+    const auto n_points = static_cast<std::size_t>(points.size());
+    std::packaged_task<void(Worker&)> task(
+        [this, &points, metric, kernel, n_points](Worker& worker) {
+          const auto start = std::chrono::steady_clock::now();
+          std::exception_ptr error;
+          try {
+            if (!worker.d_points.has_value() ||
+                static_cast<std::size_t>(worker.d_points->size()) != n_points) {
+              worker.d_points.emplace(worker.queue, static_cast<int32_t>(n_points));
+            }
+            worker.clusterer.make_clusters(worker.queue, points, *worker.d_points, metric, kernel);
+            alpaka::wait(worker.queue);
+          } catch (...) {
+            error = std::current_exception();
+          }
+          // the statistics are updated before the future becomes ready
+          std::lock_guard lock(m_mutex);
+          worker.busy_time += std::chrono::steady_clock::now() - start;
+          worker.pending_points -= n_points;
+          if (error)
+            std::rethrow_exception(error);
+          ++worker.events;
+          worker.points += n_points;
+        });
+    auto future = task.get_future();
+
+    std::lock_guard lock(m_mutex);
+    auto& worker = **std::ranges::min_element(
+        m_workers, {}, [](const auto& worker) { return worker->pending_points; });
+    worker.pending_points += n_points;
+    worker.tasks.push_back(std::move(task));
+    worker.ready.notify_one();
+    return future;
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline auto ClustererPool<Ndim, TData>::statistics() const -> std::vector<WorkerStatistics> {
+    std::lock_guard lock(m_mutex);
+    const auto lifetime =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+
+    std::vector<WorkerStatistics> statistics;
+    statistics.reserve(m_workers.size());
+    for (const auto& worker : m_workers) {
+      const auto busy_time = std::chrono::duration<double>(worker->busy_time).count();
+      statistics.push_back(WorkerStatistics{worker->device,
+                                            worker->events,
+                                            worker->points,
+                                            worker->pending_points,
+                                            busy_time,
+                                            (lifetime > 0.) ? busy_time / lifetime : 0.});
+    }
+    return statistics;
+  }
+
+}  // namespace clue
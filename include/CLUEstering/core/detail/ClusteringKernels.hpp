@@ -3,6 +3,7 @@
 
 #include "CLUEstering/core/ConvolutionalKernel.hpp"
 #include "CLUEstering/core/DistanceMetrics.hpp"
+#include "CLUEstering/core/detail/SetupSeeds.hpp"
 #include "CLUEstering/data_structures/PointsDevice.hpp"
 #include "CLUEstering/data_structures/internal/PointsCommon.hpp"
 #include "CLUEstering/data_structures/internal/DeviceVector.hpp"
@@ -11,21 +12,105 @@
 #include "CLUEstering/data_structures/internal/TilesView.hpp"
 #include "CLUEstering/detail/make_array.hpp"
 #include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/algorithm/scan/scan.hpp"
+#include "CLUEstering/internal/alpaka/exec.hpp"
 #include "CLUEstering/internal/alpaka/work_division.hpp"
 #include "CLUEstering/internal/nostd/ceil_div.hpp"
 #include "CLUEstering/internal/math/math.hpp"
 
 #include <alpaka/alpaka.hpp>
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <optional>
+#include <span>
 #include <type_traits>
 
 namespace clue::detail {
 
+  // Metrics growing monotonically with the per-coordinate differences, for which the farthest corner
+  // of a box bounds the distance of every point contained in it
+  template <typename TMetric>
+  struct is_corner_bounded_metric : std::false_type {};
+  template <std::size_t Ndim, std::floating_point TData>
+  struct is_corner_bounded_metric<EuclideanMetric<Ndim, TData>> : std::true_type {};
+  template <std::size_t Ndim, std::floating_point TData>
+  struct is_corner_bounded_metric<WeightedEuclideanMetric<Ndim, TData>> : std::true_type {};
+  template <std::size_t Ndim, std::floating_point TData>
+  struct is_corner_bounded_metric<ManhattanMetric<Ndim, TData>> : std::true_type {};
+  template <std::size_t Ndim, std::floating_point TData>
+  struct is_corner_bounded_metric<ChebyshevMetric<Ndim, TData>> : std::true_type {};
+  template <std::size_t Ndim, std::floating_point TData>
+  struct is_corner_bounded_metric<WeightedChebyshevMetric<Ndim, TData>> : std::true_type {};
+
+  template <typename TMetric>
+  inline constexpr bool is_corner_bounded_metric_v = is_corner_bounded_metric<TMetric>::value;
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  ALPAKA_FN_ACC bool tile_in_radius(const internal::TilesView<Ndim, TData>& tiles,
+                                    int32_t tile_idx,
+                                    const std::array<TData, Ndim + 1>& coords_i,
+                                    TData radius,
+                                    const DistanceMetric& metric) {
+    const auto& extremes = tiles.tileExtremes()[tile_idx];
+    auto corner = coords_i;
+    for (auto dim = 0u; dim != Ndim; ++dim) {
+      // the tiles of wrapped coordinates can be shifted by a period in the search box
+      if (tiles.wrapped()[dim])
+        return false;
+      corner[dim] = (coords_i[dim] - extremes.min(dim) > extremes.max(dim) - coords_i[dim])
+                        ? extremes.min(dim)
+                        : extremes.max(dim);
+    }
+    return metric(coords_i, corner) <= radius;
+  }
+
+  // Metrics never smaller than the difference along a single coordinate, for which the search in a
+  // tile sorted by the first coordinate can be restricted to a window around the query point
+  template <typename TMetric>
+  struct is_coordinate_bounded_metric : std::false_type {};
+  template <std::size_t Ndim, std::floating_point TData>
+  struct is_coordinate_bounded_metric<EuclideanMetric<Ndim, TData>> : std::true_type {};
+  template <std::size_t Ndim, std::floating_point TData>
+  struct is_coordinate_bounded_metric<ManhattanMetric<Ndim, TData>> : std::true_type {};
+  template <std::size_t Ndim, std::floating_point TData>
+  struct is_coordinate_bounded_metric<ChebyshevMetric<Ndim, TData>> : std::true_type {};
+
+  template <typename TMetric>
+  inline constexpr bool is_coordinate_bounded_metric_v = is_coordinate_bounded_metric<TMetric>::value;
+
+  template <typename DistanceMetric, std::size_t Ndim, std::floating_point TData>
+  ALPAKA_FN_ACC bool use_sorted_window(const internal::TilesView<Ndim, TData>& tiles) {
+    if constexpr (is_coordinate_bounded_metric_v<DistanceMetric>) {
+      return tiles.sorted && !tiles.wrapped()[0];
+    } else {
+      return false;
+    }
+  }
+
+  // Index of the first point in a sorted tile whose first coordinate is not lower than x_min
+  template <std::size_t Ndim, std::floating_point TData, std::floating_point TPointsData>
+  ALPAKA_FN_ACC std::size_t sorted_window_begin(std::span<int32_t> tile,
+                                                const PointsView<Ndim, TPointsData>& points,
+                                                TData x_min) {
+    std::size_t low = 0;
+    std::size_t high = tile.size();
+    while (low < high) {
+      const auto mid = low + (high - low) / 2;
+      if (points.coords()[0][tile[mid]] < x_min)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+    return low;
+  }
+
   template <typename TAcc,
             std::size_t Ndim,
             std::size_t N_,
@@ -42,6 +127,7 @@ namespace clue::detail {
                                    const KernelType& kernel,
                                    const std::array<TData, Ndim + 1>& coords_i,
                                    TData& rho_i,
+                                   bool& has_neighbours,
                                    TData density_radius,
                                    const DistanceMetric& metric,
                                    int32_t point_id,
@@ -50,9 +136,36 @@ namespace clue::detail {
       auto tile_idx = tiles.getGlobalBinByBin(base_vec, event);
       auto tile_size = tiles[tile_idx].size();
 
-      for (auto tile_it = 0u; tile_it < tile_size; ++tile_it) {
+      if constexpr (concepts::distance_independent_kernel<KernelType> &&
+                    is_corner_bounded_metric_v<DistanceMetric>) {
+        // a tile fully inside the radius contributes with its total weight in a single step,
+        // wherever its points are. The point itself, when it's in the tile, is taken out of the
+        // sum and added with the self value of the kernel.
+        if (tile_size > 0 && tile_in_radius(tiles, tile_idx, coords_i, density_radius, metric)) {
+          const bool self_in_tile = (tiles.getGlobalBin(coords_i.data(), event) == tile_idx);
+          auto other_weight = tiles.weightSums()[tile_idx];
+          if (self_in_tile) {
+            rho_i += kernel(TData{0}, point_id, point_id) * points.weights()[point_id];
+            other_weight -= points.weights()[point_id];
+          }
+          if (tile_size > static_cast<std::size_t>(self_in_tile)) {
+            has_neighbours = true;
+            const auto j = (tiles[tile_idx][0] != point_id) ? tiles[tile_idx][0] : tiles[tile_idx][1];
+            rho_i += kernel(TData{0}, point_id, j) * other_weight;
+          }
+          return;
+        }
+      }
+
+      const bool windowed = use_sorted_window<DistanceMetric>(tiles);
+      const auto first =
+          windowed ? sorted_window_begin(tiles[tile_idx], points, coords_i[0] - density_radius)
+                   : std::size_t{0};
+      for (auto tile_it = first; tile_it < tile_size; ++tile_it) {
         auto j = tiles[tile_idx][tile_it];
         assert(j >= 0 && j < points.size());
+        if (windowed && points.coords()[0][j] > coords_i[0] + density_radius)
+          break;
 
         const auto distance = [&]() -> TData {
           if constexpr (concepts::detail::view_distance_metric<DistanceMetric, Ndim>) {
@@ -66,6 +179,7 @@ namespace clue::detail {
         auto k = kernel(distance, point_id, j);
         assert(k >= TData{0});
         rho_i += static_cast<int>(distance <= density_radius) * k * points.weights()[j];
+        has_neighbours = has_neighbours || (distance <= density_radius && j != point_id);
       }
       return;
     } else {
@@ -81,6 +195,7 @@ namespace clue::detail {
                                           kernel,
                                           coords_i,
                                           rho_i,
+                                          has_neighbours,
                                           density_radius,
                                           metric,
                                           point_id,
@@ -89,6 +204,170 @@ namespace clue::detail {
     }
   }
 
+  // When the outlier and seeding distances do not exceed the density radius, a point without
+  // neighbours within the density radius cannot have a nearest-higher, so it is clustered as soon
+  // as its density is known and skipped by the following kernels
+  template <std::size_t Ndim, std::floating_point TData, std::floating_point TPointsData>
+  ALPAKA_FN_ACC void mark_isolated_point(PointsView<Ndim, TPointsData>& points,
+                                         int32_t point_id,
+                                         TData rho_i,
+                                         TData min_density) {
+    const auto density_uncertainty =
+        points.has_uncertainty() ? points.density_uncertainty()[point_id] : TData{1.};
+    points.nearest_higher()[point_id] = -1;
+    points.cluster_index()[point_id] = -1;
+    points.is_seed()[point_id] = (rho_i >= min_density * density_uncertainty);
+  }
+
+  // Kernels giving the same value when the two points are swapped
+  template <typename TKernel>
+  struct is_symmetric_kernel : std::false_type {};
+  template <std::floating_point TData>
+  struct is_symmetric_kernel<FlatKernel<TData>> : std::true_type {};
+  template <std::floating_point TData>
+  struct is_symmetric_kernel<GaussianKernel<TData>> : std::true_type {};
+  template <std::floating_point TData>
+  struct is_symmetric_kernel<ExponentialKernel<TData>> : std::true_type {};
+
+  // The density can be accumulated once per pair of points only when both the kernel and the
+  // metric are symmetric and the metric bounds the search boxes, so that a pair within the radius
+  // is always found from both sides. This is done only on CPU backends, where the accumulation
+  // into the second point does not need atomics, and only when enabled with setPairwiseDensity.
+  template <typename KernelType, typename DistanceMetric, concepts::device TDev>
+  inline constexpr bool use_symmetric_density_v =
+      std::same_as<TDev, alpaka::DevCpu> &&
+      is_symmetric_kernel<std::remove_cvref_t<KernelType>>::value &&
+      is_coordinate_bounded_metric_v<DistanceMetric>;
+
+  // The partial densities accumulated by the blocks of the pairwise density kernel, kept across
+  // runs. Their number is capped, so that their memory grows with the number of points only.
+  inline constexpr std::size_t max_density_partials = 8;
+
+  template <concepts::device TDev, std::floating_point TData>
+  struct PartialDensities {
+    clue::device_buffer<TDev, TData[]> rho;
+    clue::device_buffer<TDev, int32_t[]> active;
+    std::size_t size;
+
+    template <concepts::queue TQueue>
+    PartialDensities(TQueue& queue, std::size_t size_)
+        : rho{clue::make_device_buffer<TData[]>(queue, size_)},
+          active{clue::make_device_buffer<int32_t[]>(queue, size_)},
+          size{size_} {}
+  };
+
+  struct KernelCalculateLocalDensitySymmetric {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              concepts::convolutional_kernel KernelType,
+              concepts::distance_metric<Ndim> DistanceMetric,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1 &&
+               std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> tiles,
+                                  PointsView<Ndim, TPointsData> points,
+                                  TData* partial_rho,
+                                  int32_t* partial_active,
+                                  const KernelType& kernel,
+                                  TData density_radius,
+                                  DistanceMetric metric,
+                                  std::size_t nkeys) const {
+      // each block accumulates into its own partial densities, which are reduced afterwards
+      const auto block = alpaka::getIdx<alpaka::Grid, alpaka::Blocks>(acc)[0];
+      auto* rho = partial_rho + block * points.size();
+      auto* active = (partial_active != nullptr) ? partial_active + block * points.size() : nullptr;
+
+      auto accumulate_pairs = [&](int32_t i,
+                                  const std::array<TData, Ndim + 1>& coords_i,
+                                  std::span<int32_t> others) {
+        for (auto j : others) {
+          const auto distance = metric(coords_i, points[j]);
+          if (distance <= density_radius) {
+            rho[i] += kernel(distance, i, j) * points.weights()[j];
+            rho[j] += kernel(distance, j, i) * points.weights()[i];
+            if (active != nullptr) {
+              active[i] = 1;
+              active[j] = 1;
+            }
+          }
+        }
+      };
+
+      for (auto tile_idx : alpaka::uniformElements(acc, nkeys)) {
+        auto tile = tiles[tile_idx];
+        if (tile.empty())
+          continue;
+
+        for (auto tile_it = 0u; tile_it < tile.size(); ++tile_it) {
+          const auto i = tile[tile_it];
+          rho[i] += kernel(TData{0}, i, i) * points.weights()[i];
+          accumulate_pairs(i, points[i], tile.subspan(tile_it + 1));
+        }
+
+        // pairs with the neighbouring tiles are computed from the tile with the lowest index
+        const auto& extremes = tiles.tileExtremes()[tile_idx];
+        clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          searchbox_extremes[dim] = clue::nostd::make_array(extremes.min(dim) - density_radius,
+                                                            extremes.max(dim) + density_radius);
+        }
+        clue::SearchBoxBins<Ndim> searchbox_bins;
+        tiles.searchBox(searchbox_extremes, searchbox_bins);
+
+        std::array<int32_t, Ndim> bins;
+        for (auto dim = 0u; dim != Ndim; ++dim)
+          bins[dim] = searchbox_bins[dim][0];
+        while (true) {
+          const auto neighbour_idx = tiles.getGlobalBinByBin(bins);
+          if (neighbour_idx > static_cast<int32_t>(tile_idx)) {
+            auto neighbour = tiles[neighbour_idx];
+            for (auto i : tile)
+              accumulate_pairs(i, points[i], neighbour);
+          }
+
+          auto dim = 0u;
+          for (; dim != Ndim; ++dim) {
+            if (++bins[dim] <= searchbox_bins[dim][1])
+              break;
+            bins[dim] = searchbox_bins[dim][0];
+          }
+          if (dim == Ndim)
+            break;
+        }
+      }
+    }
+  };
+
+  struct KernelReducePartialDensities {
+    template <typename TAcc, std::size_t Ndim, std::floating_point TData>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim, TData> points,
+                                  const std::remove_cv_t<TData>* partial_rho,
+                                  const int32_t* partial_active,
+                                  std::size_t n_partials,
+                                  std::remove_cv_t<TData> min_density,
+                                  int32_t* active) const {
+      for (auto i : alpaka::uniformElements(acc, points.size())) {
+        auto rho_i = std::remove_cv_t<TData>{0};
+        for (auto partial = 0u; partial < n_partials; ++partial)
+          rho_i += partial_rho[partial * points.size() + i];
+        points.rho()[i] = rho_i;
+
+        if (active != nullptr) {
+          int32_t active_i = 0;
+          for (auto partial = 0u; partial < n_partials; ++partial)
+            active_i = active_i || partial_active[partial * points.size() + i];
+          active[i] = active_i;
+          if (!active_i)
+            mark_isolated_point(points, static_cast<int32_t>(i), rho_i, min_density);
+        }
+      }
+    }
+  };
+
   struct KernelCalculateLocalDensity {
     template <typename TAcc,
               std::size_t Ndim,
@@ -103,9 +382,12 @@ namespace clue::detail {
                                   PointsView<Ndim, TPointsData> points,
                                   const KernelType& kernel,
                                   TData density_radius,
-                                  DistanceMetric metric) const {
+                                  DistanceMetric metric,
+                                  TData min_density,
+                                  int32_t* active) const {
       for (auto i : alpaka::uniformElements(acc, points.size())) {
         auto rho_i = static_cast<TData>(0.);
+        bool has_neighbours = false;
         auto coords_i = points[i];
 
         clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
@@ -129,12 +411,116 @@ namespace clue::detail {
                                         kernel,
                                         coords_i,
                                         rho_i,
+                                        has_neighbours,
                                         density_radius,
                                         metric,
                                         i);
 
         assert(rho_i >= TData{0});
         points.rho()[i] = rho_i;
+        if (active != nullptr) {
+          active[i] = has_neighbours;
+          if (!has_neighbours)
+            mark_isolated_point(points, static_cast<int32_t>(i), rho_i, min_density);
+        }
+      }
+    }
+  };
+
+  struct KernelSortTiles {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1 &&
+               std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> tiles,
+                                  PointsView<Ndim, TPointsData> points,
+                                  std::size_t nkeys) const {
+      for (auto tile_idx : alpaka::uniformElements(acc, nkeys)) {
+        auto tile = tiles[tile_idx];
+        // order by first coordinate, ties broken by index so that the order is reproducible
+        auto less = [&](int32_t lhs, int32_t rhs) {
+          const auto x_lhs = points.coords()[0][lhs];
+          const auto x_rhs = points.coords()[0][rhs];
+          return (x_lhs < x_rhs) || (x_lhs == x_rhs && lhs < rhs);
+        };
+        auto sift_down = [&](std::size_t root, std::size_t end) {
+          while (2 * root + 1 < end) {
+            auto child = 2 * root + 1;
+            if (child + 1 < end && less(tile[child], tile[child + 1]))
+              ++child;
+            if (!less(tile[root], tile[child]))
+              return;
+            const auto tmp = tile[root];
+            tile[root] = tile[child];
+            tile[child] = tmp;
+            root = child;
+          }
+        };
+
+        // in-place heap sort, since tiles can be much larger than the average on skewed data
+        const auto size = tile.size();
+        for (auto start = size / 2; start > 0; --start)
+          sift_down(start - 1, size);
+        for (auto end = size; end > 1; --end) {
+          const auto tmp = tile[0];
+          tile[0] = tile[end - 1];
+          tile[end - 1] = tmp;
+          sift_down(0, end - 1);
+        }
+      }
+    }
+  };
+
+  struct KernelComputeTileExtremes {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1 &&
+               std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> tiles,
+                                  PointsView<Ndim, TPointsData> points,
+                                  std::size_t nkeys) const {
+      for (auto tile_idx : alpaka::uniformElements(acc, nkeys)) {
+        auto& extremes = tiles.tileExtremes()[tile_idx];
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          extremes.min(dim) = std::numeric_limits<TData>::max();
+          extremes.max(dim) = std::numeric_limits<TData>::lowest();
+        }
+        auto weight_sum = TData{0};
+        for (auto j : tiles[tile_idx]) {
+          for (auto dim = 0u; dim != Ndim; ++dim) {
+            extremes.min(dim) = math::min(extremes.min(dim), points.coords()[dim][j]);
+            extremes.max(dim) = math::max(extremes.max(dim), points.coords()[dim][j]);
+          }
+          weight_sum += points.weights()[j];
+        }
+        tiles.weightSums()[tile_idx] = weight_sum;
+      }
+    }
+  };
+
+  struct KernelComputeTileMaxDensity {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1 &&
+               std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> tiles,
+                                  PointsView<Ndim, TPointsData> points,
+                                  std::size_t nkeys) const {
+      for (auto tile_idx : alpaka::uniformElements(acc, nkeys)) {
+        auto max_rho = TData{0};
+        for (auto j : tiles[tile_idx]) {
+          max_rho = math::max(max_rho, points.rho()[j]);
+        }
+        tiles.maxRho()[tile_idx] = max_rho;
       }
     }
   };
@@ -163,6 +549,9 @@ namespace clue::detail {
                                                   std::size_t event = 0) {
     if constexpr (N_ == 0) {
       auto tile_idx = tiles.getGlobalBinByBin(base_vec, event);
+      // no point in a tile whose densest point is strictly lower than rho_i can be a nearest-higher
+      if (tiles.maxRho()[tile_idx] < rho_i)
+        return;
       auto tile_size = tiles[tile_idx].size();
 
       const auto effective_distance = (rho_i >= min_density) ? seeding_distance : outlier_distance;
@@ -172,10 +561,16 @@ namespace clue::detail {
       };
 
       auto point_tag = tag(point_id);
-      for (auto tile_it = 0u; tile_it < tile_size; ++tile_it) {
+      const bool windowed = use_sorted_window<DistanceMetric>(tiles);
+      const auto first =
+          windowed ? sorted_window_begin(tiles[tile_idx], points, coords_i[0] - effective_distance)
+                   : std::size_t{0};
+      for (auto tile_it = first; tile_it < tile_size; ++tile_it) {
         const auto j = tiles[tile_idx][tile_it];
-        const auto tag_j = tag(j);
         assert(j >= 0 && j < points.size());
+        if (windowed && points.coords()[0][j] > coords_i[0] + effective_distance)
+          break;
+        const auto tag_j = tag(j);
         auto rho_j = points.rho()[j];
         bool found_higher_in_tile = (rho_j > rho_i);
         found_higher_in_tile =
@@ -243,8 +638,12 @@ namespace clue::detail {
                                   TData seeding_distance,
                                   TData min_density,
                                   DistanceMetric metric,
-                                  std::size_t* seed_candidates) const {
-      for (auto i : alpaka::uniformElements(acc, points.size())) {
+                                  const int32_t* active_points,
+                                  std::size_t n_active,
+                                  bool warm_start) const {
+      const auto n_points = (active_points != nullptr) ? n_active : points.size();
+      for (auto k : alpaka::uniformElements(acc, n_points)) {
+        const auto i = (active_points != nullptr) ? static_cast<decltype(k)>(active_points[k]) : k;
         auto delta_i = std::numeric_limits<TData>::max();
         int nh_i = -1;
         auto coords_i = points[i];
@@ -253,11 +652,42 @@ namespace clue::detail {
             points.has_uncertainty() ? points.density_uncertainty()[i] : TData{1.};
         const auto effective_min_density = min_density * density_uncertainty;
 
+        // the nearest-higher of the previous frame, if it is still a valid candidate, bounds the
+        // distance of the nearest-higher, so the search box is shrunk to that distance
+        if (warm_start && points.nearest_higher()[i] >= 0) {
+          const auto previous = points.nearest_higher()[i];
+          auto tag = [&points](std::integral auto idx) -> std::size_t {
+            return (points.has_tags()) ? points.tags()[idx] : static_cast<std::size_t>(idx);
+          };
+          const auto rho_previous = points.rho()[previous];
+          const bool higher = (rho_previous > rho_i) || ((rho_previous == rho_i) &&
+                                                         (rho_previous > TData{0}) &&
+                                                         (tag(previous) > tag(i)));
+          const auto distance = [&]() -> TData {
+            if constexpr (concepts::detail::view_distance_metric<DistanceMetric, Ndim>) {
+              return metric(
+                  points, static_cast<std::size_t>(i), static_cast<std::size_t>(previous));
+            } else {
+              return metric(coords_i, points[previous]);
+            }
+          }();
+          const auto effective_distance =
+              (rho_i >= effective_min_density) ? seeding_distance : outlier_distance;
+          if (higher && distance <= effective_distance) {
+            delta_i = distance;
+            nh_i = previous;
+          }
+        }
+
         clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
         for (auto dim = 0u; dim != Ndim; ++dim) {
           const auto sigma_i = points.has_sigma(dim) ? points.sigma(dim)[i] : TData{0};
-          const auto box_radius =
+          auto box_radius =
               math::max(outlier_distance, outlier_distance * sigma_i * math::sqrt(TData{2}));
+          // the distances of the metrics reading the sigmas are not coordinate differences
+          if constexpr (!concepts::detail::view_distance_metric<DistanceMetric, Ndim>) {
+            box_radius = math::min(box_radius, delta_i);
+          }
           searchbox_extremes[dim] =
               clue::nostd::make_array(coords_i[dim] - box_radius, coords_i[dim] + box_radius);
         }
@@ -283,38 +713,266 @@ namespace clue::detail {
 
         assert(nh_i == -1 || delta_i <= outlier_distance);
         points.nearest_higher()[i] = nh_i;
-        if (nh_i == -1) {
-          alpaka::atomicAdd(acc, seed_candidates, std::size_t{1});
+        points.cluster_index()[i] = -1;
+        points.is_seed()[i] = (nh_i == -1) && (rho_i >= effective_min_density);
+      }
+    }
+  };
+
+  // Calls a function on the global index of each tile of a search box
+  template <std::size_t Ndim, std::size_t N_, std::floating_point TData, typename TFunc>
+  ALPAKA_FN_ACC void for_each_tile(std::array<int32_t, Ndim>& base_vec,
+                                   const clue::SearchBoxBins<Ndim>& search_box,
+                                   const internal::TilesView<Ndim, TData>& tiles,
+                                   TFunc& func) {
+    if constexpr (N_ == 0) {
+      func(tiles.getGlobalBinByBin(base_vec));
+    } else {
+      for (auto i = search_box[search_box.size() - N_][0];
+           i <= search_box[search_box.size() - N_][1];
+           ++i) {
+        base_vec[Ndim - N_] = i;
+        for_each_tile<Ndim, N_ - 1>(base_vec, search_box, tiles, func);
+      }
+    }
+  }
+
+  // Labels new points with the clusters of the reference points of the last run. The density of
+  // each new point is computed against the reference points, and its nearest-higher is searched
+  // among them with the rules of the nearest-higher kernel, the new point being lower than the
+  // reference points with the same density. The new points are not seeds and are not compared
+  // with each other.
+  struct KernelAssignPoints {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              concepts::convolutional_kernel KernelType,
+              concepts::distance_metric<Ndim> DistanceMetric,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1 &&
+               std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> density_tiles,
+                                  internal::TilesView<Ndim, TData> nearest_higher_tiles,
+                                  PointsView<Ndim, TPointsData> reference,
+                                  PointsView<Ndim, TPointsData> points,
+                                  const KernelType& kernel,
+                                  TData density_radius,
+                                  TData outlier_distance,
+                                  TData seeding_distance,
+                                  TData min_density,
+                                  DistanceMetric metric) const {
+      // the new points have no index among the reference points, so they are passed to the
+      // convolutional kernel with an index that no reference point has
+      constexpr int new_point = -1;
+      auto tag = [&reference](std::integral auto idx) -> std::size_t {
+        return (reference.has_tags()) ? reference.tags()[idx] : static_cast<std::size_t>(idx);
+      };
+
+      for (auto i : alpaka::uniformElements(acc, points.size())) {
+        const auto coords_i = points[i];
+        auto rho_i = kernel(TData{0}, new_point, new_point) * points.weights()[i];
+
+        clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          searchbox_extremes[dim] = clue::nostd::make_array(coords_i[dim] - density_radius,
+                                                            coords_i[dim] + density_radius);
+        }
+        clue::SearchBoxBins<Ndim> searchbox_bins;
+        density_tiles.searchBox(searchbox_extremes, searchbox_bins);
+
+        std::array<int32_t, Ndim> base_vec{};
+        const bool density_windowed = use_sorted_window<DistanceMetric>(density_tiles);
+        auto add_density = [&](int32_t tile_idx) {
+          const auto tile = density_tiles[tile_idx];
+          const auto first =
+              density_windowed
+                  ? sorted_window_begin(tile, reference, coords_i[0] - density_radius)
+                  : std::size_t{0};
+          for (auto tile_it = first; tile_it < tile.size(); ++tile_it) {
+            const auto j = tile[tile_it];
+            if (density_windowed && reference.coords()[0][j] > coords_i[0] + density_radius)
+              break;
+            const auto distance = metric(coords_i, reference[j]);
+            if (distance <= density_radius)
+              rho_i += kernel(distance, new_point, j) * reference.weights()[j];
+          }
+        };
+        for_each_tile<Ndim, Ndim>(base_vec, searchbox_bins, density_tiles, add_density);
+
+        const auto density_uncertainty =
+            points.has_uncertainty() ? points.density_uncertainty()[i] : TData{1.};
+        const auto effective_distance =
+            (rho_i >= min_density * density_uncertainty) ? seeding_distance : outlier_distance;
+
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          searchbox_extremes[dim] = clue::nostd::make_array(coords_i[dim] - outlier_distance,
+                                                            coords_i[dim] + outlier_distance);
         }
+        nearest_higher_tiles.searchBox(searchbox_extremes, searchbox_bins);
+
+        auto delta_i = std::numeric_limits<TData>::max();
+        int nh_i = -1;
+        const bool nearest_higher_windowed =
+            use_sorted_window<DistanceMetric>(nearest_higher_tiles);
+        auto find_nearest_higher = [&](int32_t tile_idx) {
+          if (nearest_higher_tiles.maxRho()[tile_idx] < rho_i)
+            return;
+          const auto tile = nearest_higher_tiles[tile_idx];
+          const auto first =
+              nearest_higher_windowed
+                  ? sorted_window_begin(tile, reference, coords_i[0] - effective_distance)
+                  : std::size_t{0};
+          for (auto tile_it = first; tile_it < tile.size(); ++tile_it) {
+            const auto j = tile[tile_it];
+            if (nearest_higher_windowed &&
+                reference.coords()[0][j] > coords_i[0] + effective_distance)
+              break;
+            const auto rho_j = reference.rho()[j];
+            if (rho_j < rho_i || (rho_j == rho_i && rho_j <= TData{0}))
+              continue;
+
+            const auto distance = metric(coords_i, reference[j]);
+            if (distance <= effective_distance &&
+                ((distance < delta_i) ||
+                 ((distance == delta_i) && (nh_i >= 0) &&
+                  ((rho_j > reference.rho()[nh_i]) ||
+                   ((rho_j == reference.rho()[nh_i]) && (tag(j) > tag(nh_i))))))) {
+              delta_i = distance;
+              nh_i = j;
+            }
+          }
+        };
+        for_each_tile<Ndim, Ndim>(
+            base_vec, searchbox_bins, nearest_higher_tiles, find_nearest_higher);
+
+        points.rho()[i] = rho_i;
+        points.nearest_higher()[i] = nh_i;
+        points.cluster_index()[i] = (nh_i >= 0) ? reference.cluster_index()[nh_i] : -1;
+        points.is_seed()[i] = 0;
       }
     }
   };
 
-  struct KernelFindClusters {
-    template <typename TAcc, std::size_t Ndim, std::floating_point TData>
+  // Computes densities and nearest-highers of a small set of points by comparing all the pairs,
+  // without building the tiles. It is launched on a single block, so that the nearest-higher
+  // search can start as soon as all the densities of the block are available.
+  struct KernelBruteForceDensityAndNearestHigher {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              concepts::convolutional_kernel KernelType,
+              concepts::distance_metric<Ndim> DistanceMetric>
       requires(alpaka::Dim<TAcc>::value == 1)
     ALPAKA_FN_ACC void operator()(const TAcc& acc,
-                                  clue::internal::SeedArrayView seeds,
                                   PointsView<Ndim, TData> points,
-                                  TData min_density) const {
-      for (auto i : alpaka::uniformElements(acc, points.size())) {
-        points.cluster_index()[i] = -1;
-        const auto nh = points.nearest_higher()[i];
+                                  const KernelType& kernel,
+                                  std::remove_cv_t<TData> density_radius,
+                                  std::remove_cv_t<TData> outlier_distance,
+                                  std::remove_cv_t<TData> seeding_distance,
+                                  std::remove_cv_t<TData> min_density,
+                                  DistanceMetric metric) const {
+      using value_type = std::remove_cv_t<TData>;
+      const auto n_points = points.size();
+      auto distance = [&](auto i, auto j) -> value_type {
+        if constexpr (concepts::detail::view_distance_metric<DistanceMetric, Ndim>) {
+          return metric(points, static_cast<std::size_t>(i), static_cast<std::size_t>(j));
+        } else {
+          return metric(points[i], points[j]);
+        }
+      };
+
+      for (auto i : alpaka::uniformElements(acc, n_points)) {
+        auto rho_i = value_type{0};
+        for (auto j = 0u; j < n_points; ++j) {
+          const auto distance_ij = distance(i, j);
+          if (distance_ij <= density_radius)
+            rho_i += kernel(distance_ij, static_cast<int32_t>(i), static_cast<int32_t>(j)) *
+                     points.weights()[j];
+        }
+        points.rho()[i] = rho_i;
+      }
+      alpaka::syncBlockThreads(acc);
+
+      auto tag = [&points](std::integral auto idx) -> std::size_t {
+        return (points.has_tags()) ? points.tags()[idx] : static_cast<std::size_t>(idx);
+      };
+      for (auto i : alpaka::uniformElements(acc, n_points)) {
         const auto rho_i = points.rho()[i];
+        const auto tag_i = tag(i);
         const auto density_uncertainty =
-            points.has_uncertainty() ? points.density_uncertainty()[i] : TData{1.};
-        const auto is_seed = (nh == -1) && (rho_i >= min_density * density_uncertainty);
+            points.has_uncertainty() ? points.density_uncertainty()[i] : value_type{1.};
+        const auto effective_min_density = min_density * density_uncertainty;
+        const auto effective_distance =
+            (rho_i >= effective_min_density) ? seeding_distance : outlier_distance;
 
-        if (is_seed) {
-          points.is_seed()[i] = 1;
-          seeds.push_back(acc, i);
-        } else {
-          points.is_seed()[i] = 0;
+        auto delta_i = std::numeric_limits<value_type>::max();
+        int nh_i = -1;
+        for (auto j = 0u; j < n_points; ++j) {
+          const auto rho_j = points.rho()[j];
+          const auto tag_j = tag(j);
+          const bool higher =
+              (rho_j > rho_i) || ((rho_j == rho_i) && (rho_j > value_type{0}) && (tag_j > tag_i));
+          if (!higher)
+            continue;
+
+          const auto distance_ij = distance(i, j);
+          if (distance_ij <= effective_distance &&
+              ((distance_ij < delta_i) ||
+               ((distance_ij == delta_i) && (nh_i >= 0) &&
+                ((rho_j > points.rho()[nh_i]) ||
+                 ((rho_j == points.rho()[nh_i]) && (tag_j > tag(nh_i))))))) {
+            delta_i = distance_ij;
+            nh_i = static_cast<int>(j);
+          }
+        }
+
+        points.nearest_higher()[i] = nh_i;
+        points.cluster_index()[i] = -1;
+        points.is_seed()[i] = (nh_i == -1) && (rho_i >= effective_min_density);
+      }
+    }
+  };
+
+  // Writes the seeds in the positions given by the inclusive scan of the seed flags, so that the
+  // cluster indexes follow the order of the points independently of the scheduling
+  struct KernelCompactSeeds {
+    template <typename TAcc, std::size_t Ndim, std::floating_point TData>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  clue::internal::SeedArrayView seeds,
+                                  PointsView<Ndim, TData> points,
+                                  const int32_t* seed_positions) const {
+      const auto n_points = points.size();
+      for (auto i : alpaka::uniformElements(acc, n_points)) {
+        if (points.is_seed()[i]) {
+          const auto cluster_index = seed_positions[i] - 1;
+          seeds[cluster_index] = static_cast<int32_t>(i);
+          points.cluster_index()[i] = cluster_index;
+        }
+        if (i == n_points - 1) {
+          seeds.resize(static_cast<std::size_t>(seed_positions[i]));
         }
       }
     }
   };
 
+  // Lists the points flagged as active, given the inclusive scan of the flags
+  struct KernelCompactActivePoints {
+    template <typename TAcc>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  const int32_t* active_positions,
+                                  int32_t* active_points,
+                                  std::size_t n_points) const {
+      for (auto i : alpaka::uniformElements(acc, n_points)) {
+        const auto previous = (i > 0) ? active_positions[i - 1] : 0;
+        if (active_positions[i] > previous)
+          active_points[previous] = static_cast<int32_t>(i);
+      }
+    }
+  };
+
   struct KernelAssignSeedIndices {
     template <typename TAcc, std::size_t Ndim, std::floating_point TData>
     ALPAKA_FN_ACC void operator()(const TAcc& acc,
@@ -328,8 +986,14 @@ namespace clue::detail {
 
   struct KernelAssignClusters {
     template <typename TAcc, std::size_t Ndim, std::floating_point TData>
-    ALPAKA_FN_ACC void operator()(const TAcc& acc, PointsView<Ndim, TData> points) const {
-      for (auto idx : alpaka::uniformElements(acc, points.size())) {
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim, TData> points,
+                                  const int32_t* active_points,
+                                  std::size_t n_active) const {
+      const auto n_points = (active_points != nullptr) ? n_active : points.size();
+      for (auto k : alpaka::uniformElements(acc, n_points)) {
+        const auto idx =
+            (active_points != nullptr) ? static_cast<decltype(k)>(active_points[k]) : k;
         if (points.is_seed()[idx] || points.nearest_higher()[idx] == -1)
           continue;
 
@@ -358,15 +1022,143 @@ namespace clue::detail {
                                   PointsView<Ndim, TPointsData>& points,
                                   KernelType&& kernel,
                                   TData density_radius,
-                                  const DistanceMetric& metric) {
-    alpaka::exec<TAcc>(queue,
-                       work_division,
-                       KernelCalculateLocalDensity{},
-                       tiles,
-                       points,
-                       std::forward<KernelType>(kernel),
-                       density_radius,
-                       metric);
+                                  const DistanceMetric& metric,
+                                  TData min_density = TData{0},
+                                  int32_t* active = nullptr) {
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelCalculateLocalDensity{},
+                         tiles,
+                         points,
+                         std::forward<KernelType>(kernel),
+                         density_radius,
+                         metric,
+                         min_density,
+                         active);
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1 &&
+             std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+  inline void sortTiles(TQueue& queue,
+                        std::size_t block_size,
+                        internal::TilesView<Ndim, TData>& tiles,
+                        PointsView<Ndim, TPointsData>& points,
+                        std::size_t nkeys) {
+    const Idx grid_size = nostd::ceil_div(nkeys, block_size);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(grid_size, block_size),
+                         KernelSortTiles{},
+                         tiles,
+                         points,
+                         nkeys);
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1 &&
+             std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+  inline void computeTileExtremes(TQueue& queue,
+                                  std::size_t block_size,
+                                  internal::TilesView<Ndim, TData>& tiles,
+                                  PointsView<Ndim, TPointsData>& points,
+                                  std::size_t nkeys) {
+    const Idx grid_size = nostd::ceil_div(nkeys, block_size);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(grid_size, block_size),
+                         KernelComputeTileExtremes{},
+                         tiles,
+                         points,
+                         nkeys);
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1 &&
+             std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+  inline void computeTileMaxDensity(TQueue& queue,
+                                    std::size_t block_size,
+                                    internal::TilesView<Ndim, TData>& tiles,
+                                    PointsView<Ndim, TPointsData>& points,
+                                    std::size_t nkeys) {
+    const Idx grid_size = nostd::ceil_div(nkeys, block_size);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(grid_size, block_size),
+                         KernelComputeTileMaxDensity{},
+                         tiles,
+                         points,
+                         nkeys);
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel KernelType,
+            concepts::distance_metric<Ndim> DistanceMetric,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1 &&
+             std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+  inline void computeLocalDensitySymmetric(
+      TQueue& queue,
+      std::size_t block_size,
+      internal::TilesView<Ndim, TData>& tiles,
+      PointsView<Ndim, TPointsData>& points,
+      KernelType&& kernel,
+      TData density_radius,
+      const DistanceMetric& metric,
+      std::size_t nkeys,
+      std::optional<PartialDensities<alpaka::Dev<TQueue>, TData>>& partials,
+      TData min_density = TData{0},
+      int32_t* active = nullptr) {
+    const auto n_cores = alpaka::getAccDevProps<TAcc>(alpaka::getDev(queue)).m_multiProcessorCount;
+    const auto n_partials =
+        std::clamp<std::size_t>(n_cores, 1, std::min(nkeys, max_density_partials));
+    const auto partials_size = n_partials * static_cast<std::size_t>(points.size());
+    if (!partials.has_value() || partials->size < partials_size)
+      partials.emplace(queue, partials_size);
+
+    auto partial_rho =
+        clue::make_device_view(alpaka::getDev(queue), partials->rho.data(), partials_size);
+    alpaka::memset(queue, partial_rho, 0);
+    auto* partial_active_ptr = (active != nullptr) ? partials->active.data() : nullptr;
+    if (active != nullptr) {
+      auto partial_active =
+          clue::make_device_view(alpaka::getDev(queue), partials->active.data(), partials_size);
+      alpaka::memset(queue, partial_active, 0);
+    }
+
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(n_partials, nostd::ceil_div(nkeys, n_partials)),
+                         KernelCalculateLocalDensitySymmetric{},
+                         tiles,
+                         points,
+                         partials->rho.data(),
+                         partial_active_ptr,
+                         std::forward<KernelType>(kernel),
+                         density_radius,
+                         metric,
+                         nkeys);
+    const Idx grid_size = nostd::ceil_div(points.size(), block_size);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(grid_size, block_size),
+                         KernelReducePartialDensities{},
+                         points,
+                         partials->rho.data(),
+                         partial_active_ptr,
+                         n_partials,
+                         min_density,
+                         active);
   }
 
   template <concepts::accelerator TAcc,
@@ -385,35 +1177,132 @@ namespace clue::detail {
                                     TData seeding_distance,
                                     TData min_density,
                                     const DistanceMetric& metric,
-                                    std::size_t& seed_candidates) {
-    auto d_seed_candidates = clue::make_device_buffer<std::size_t>(queue);
-    alpaka::memset(queue, d_seed_candidates, 0u);
-    alpaka::exec<TAcc>(queue,
-                       work_division,
-                       KernelCalculateNearestHigher{},
-                       tiles,
-                       points,
-                       outlier_distance,
-                       seeding_distance,
-                       min_density,
-                       metric,
-                       d_seed_candidates.data());
-    alpaka::memcpy(queue, clue::make_host_view(seed_candidates), d_seed_candidates);
+                                    const int32_t* active_points = nullptr,
+                                    std::size_t n_active = 0,
+                                    bool warm_start = false) {
+    if (active_points != nullptr && n_active == 0)
+      return;
+
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelCalculateNearestHigher{},
+                         tiles,
+                         points,
+                         outlier_distance,
+                         seeding_distance,
+                         min_density,
+                         metric,
+                         active_points,
+                         n_active,
+                         warm_start);
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel KernelType,
+            concepts::distance_metric<Ndim> DistanceMetric>
+    requires(alpaka::Dim<TAcc>::value == 1)
+  inline void computeBruteForceDensityAndNearestHighers(TQueue& queue,
+                                                        std::size_t block_size,
+                                                        PointsView<Ndim, TData>& points,
+                                                        KernelType&& kernel,
+                                                        std::remove_cv_t<TData> density_radius,
+                                                        std::remove_cv_t<TData> outlier_distance,
+                                                        std::remove_cv_t<TData> seeding_distance,
+                                                        std::remove_cv_t<TData> min_density,
+                                                        const DistanceMetric& metric) {
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(1, block_size),
+                         KernelBruteForceDensityAndNearestHigher{},
+                         points,
+                         std::forward<KernelType>(kernel),
+                         density_radius,
+                         outlier_distance,
+                         seeding_distance,
+                         min_density,
+                         metric);
+  }
+
+  // Scans in place the flags of the points that are not isolated and lists them, returning how
+  // many they are
+  template <concepts::accelerator TAcc, concepts::queue TQueue>
+    requires(alpaka::Dim<TAcc>::value == 1)
+  inline std::size_t compactActivePoints(TQueue& queue,
+                                         const WorkDiv& work_division,
+                                         int32_t* active,
+                                         int32_t* active_points,
+                                         std::size_t n_points) {
+    if (n_points == 0)
+      return 0;
+
+    internal::algorithm::inclusive_scan(queue, active, active + n_points, active);
+    internal::exec<TAcc>(
+        queue, work_division, KernelCompactActivePoints{}, active, active_points, n_points);
+    auto n_active = int32_t{0};
+    alpaka::memcpy(queue,
+                   clue::make_host_view(n_active),
+                   clue::make_device_view(alpaka::getDev(queue), active + n_points - 1, 1u));
     alpaka::wait(queue);
+    return static_cast<std::size_t>(n_active);
   }
 
+  // Lists the seeds with the device-wide scan of their flags. The seed array is sized on the number
+  // of points, which bounds the number of seeds, and its size is set on the device by the
+  // compaction kernel, so that nothing is read back. The positions of the scan are kept across
+  // runs, and the cluster indexes follow the order of the seeds in the input.
   template <concepts::accelerator TAcc,
             concepts::queue TQueue,
             std::size_t Ndim,
             std::floating_point TData>
     requires(alpaka::Dim<TAcc>::value == 1)
-  inline void findClusterSeeds(TQueue& queue,
-                               const WorkDiv& work_division,
-                               clue::internal::SeedArray<>& seeds,
-                               PointsView<Ndim, TData>& points,
-                               TData min_density) {
-    alpaka::exec<TAcc>(
-        queue, work_division, KernelFindClusters{}, seeds.view(), points, min_density);
+  inline void findClusterSeeds(
+      TQueue& queue,
+      const WorkDiv& work_division,
+      std::optional<clue::internal::SeedArray<>>& seeds,
+      std::optional<clue::device_buffer<alpaka::Dev<TQueue>, int32_t[]>>& seed_positions,
+      PointsView<Ndim, TData>& points) {
+    const auto n_points = points.size();
+    if (!seed_positions.has_value() ||
+        alpaka::getExtents(*seed_positions)[0] < static_cast<Idx>(n_points))
+      seed_positions = clue::make_device_buffer<int32_t[]>(queue, n_points);
+    setup_seeds(queue, seeds, static_cast<std::size_t>(n_points));
+    if (n_points == 0)
+      return;
+
+    internal::algorithm::inclusive_scan(queue,
+                                        points.is_seed().data(),
+                                        points.is_seed().data() + n_points,
+                                        seed_positions->data());
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelCompactSeeds{},
+                         seeds->view(),
+                         points,
+                         seed_positions->data());
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData>
+  inline void followNearestHighers(TQueue& queue,
+                                   std::size_t block_size,
+                                   PointsView<Ndim, TData> points,
+                                   const int32_t* active_points = nullptr,
+                                   std::size_t n_active = 0) {
+    const auto n_points = (active_points != nullptr) ? n_active : points.size();
+    if (n_points == 0)
+      return;
+
+    const Idx point_grid = nostd::ceil_div(n_points, block_size);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(point_grid, block_size),
+                         KernelAssignClusters{},
+                         points,
+                         active_points,
+                         n_active);
   }
 
   template <concepts::accelerator TAcc,
@@ -434,15 +1323,53 @@ namespace clue::detail {
     }
 
     const Idx seed_grid = nostd::ceil_div(nseeds, block_size);
-    alpaka::exec<TAcc>(queue,
-                       clue::make_workdiv<TAcc>(seed_grid, block_size),
-                       KernelAssignSeedIndices{},
-                       seeds.view(),
-                       points);
-
-    const Idx point_grid = nostd::ceil_div(points.size(), block_size);
-    alpaka::exec<TAcc>(
-        queue, clue::make_workdiv<TAcc>(point_grid, block_size), KernelAssignClusters{}, points);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(seed_grid, block_size),
+                         KernelAssignSeedIndices{},
+                         seeds.view(),
+                         points);
+
+    followNearestHighers<TAcc>(queue, block_size, points);
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel KernelType,
+            concepts::distance_metric<Ndim> DistanceMetric,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1 &&
+             std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+  inline void assignPoints(TQueue& queue,
+                           std::size_t block_size,
+                           const internal::TilesView<Ndim, TData>& density_tiles,
+                           const internal::TilesView<Ndim, TData>& nearest_higher_tiles,
+                           const PointsView<Ndim, TPointsData>& reference,
+                           PointsView<Ndim, TPointsData>& points,
+                           const KernelType& kernel,
+                           TData density_radius,
+                           TData outlier_distance,
+                           TData seeding_distance,
+                           TData min_density,
+                           const DistanceMetric& metric) {
+    if (points.size() == 0)
+      return;
+
+    const Idx grid_size = nostd::ceil_div(points.size(), block_size);
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(grid_size, block_size),
+                         KernelAssignPoints{},
+                         density_tiles,
+                         nearest_higher_tiles,
+                         reference,
+                         points,
+                         kernel,
+                         density_radius,
+                         outlier_distance,
+                         seeding_distance,
+                         min_density,
+                         metric);
   }
 
 }  // namespace clue::detail
@@ -5,11 +5,19 @@
 #include "CLUEstering/data_structures/PointsDevice.hpp"
 #include "CLUEstering/data_structures/internal/CoordinateExtremes.hpp"
 #include "CLUEstering/data_structures/internal/Tiles.hpp"
+#include "CLUEstering/data_structures/internal/TilesView.hpp"
+#include "CLUEstering/detail/concepts.hpp"
 #include "CLUEstering/internal/algorithm/algorithm.hpp"
+#include "CLUEstering/internal/alpaka/exec.hpp"
+#include "CLUEstering/internal/alpaka/work_division.hpp"
+#include "CLUEstering/internal/math/math.hpp"
 #include "CLUEstering/internal/nostd/maximum.hpp"
 #include "CLUEstering/internal/nostd/minimum.hpp"
+#include <alpaka/alpaka.hpp>
 #include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <limits>
 
 namespace clue::detail {
 
@@ -61,4 +69,77 @@ namespace clue::detail {
     }
   }
 
+  // Reduces the extremes of all the points of a batch in a single block and starts every event
+  // from them, with the tile sizes of the grid of the tiles. The batched clustering then narrows
+  // them down to the extremes of each event.
+  struct KernelComputeBatchExtremes {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1 &&
+               std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> tiles,
+                                  PointsView<Ndim, TPointsData> points,
+                                  std::size_t batch_size) const {
+      auto& extremes =
+          alpaka::declareSharedVar<internal::CoordinateExtremes<Ndim, TData>, __COUNTER__>(acc);
+
+      if (alpaka::oncePerBlock(acc)) {
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          extremes.min(dim) = std::numeric_limits<TData>::max();
+          extremes.max(dim) = std::numeric_limits<TData>::lowest();
+        }
+      }
+      alpaka::syncBlockThreads(acc);
+
+      internal::CoordinateExtremes<Ndim, TData> thread_extremes;
+      for (auto dim = 0u; dim != Ndim; ++dim) {
+        thread_extremes.min(dim) = std::numeric_limits<TData>::max();
+        thread_extremes.max(dim) = std::numeric_limits<TData>::lowest();
+      }
+      for (auto i : alpaka::independentGroupElements(acc, points.size())) {
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          const auto coord = points.coords()[dim][i];
+          thread_extremes.min(dim) = math::min(thread_extremes.min(dim), coord);
+          thread_extremes.max(dim) = math::max(thread_extremes.max(dim), coord);
+        }
+      }
+      for (auto dim = 0u; dim != Ndim; ++dim) {
+        alpaka::atomicMin(acc, &extremes.min(dim), thread_extremes.min(dim));
+        alpaka::atomicMax(acc, &extremes.max(dim), thread_extremes.max(dim));
+      }
+      alpaka::syncBlockThreads(acc);
+
+      for (auto event : alpaka::independentGroupElements(acc, batch_size)) {
+        for (auto dim = 0u; dim != Ndim; ++dim) {
+          tiles.minMax()[event].min(dim) = extremes.min(dim);
+          tiles.minMax()[event].max(dim) = extremes.max(dim);
+          tiles.tileSize()[event * Ndim + dim] = extremes.range(dim) / tiles.nperdim;
+        }
+      }
+    }
+  };
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1 &&
+             std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+  inline void computeBatchExtremes(TQueue& queue,
+                                   std::size_t block_size,
+                                   internal::TilesView<Ndim, TData> tiles,
+                                   PointsView<Ndim, TPointsData> points,
+                                   std::size_t batch_size) {
+    internal::exec<TAcc>(queue,
+                         clue::make_workdiv<TAcc>(1, block_size),
+                         KernelComputeBatchExtremes{},
+                         tiles,
+                         points,
+                         batch_size);
+  }
+
 }  // namespace clue::detail
@@ -0,0 +1,177 @@
+
+#pragma once
+
+#include "CLUEstering/core/Clusterer.hpp"
+#include "CLUEstering/core/EventBatcher.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+
+#include <alpaka/alpaka.hpp>
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace clue {
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  template <concepts::queue TQueue>
+  inline EventBatcher<Ndim, TData, Kernel, DistanceMetric>::EventBatcher(
+      TQueue& queue,
+      Clusterer<Ndim, value_type>& clusterer,
+      std::size_t max_points,
+      const DistanceMetric& metric,
+      const Kernel& kernel)
+      : m_clusterer{clusterer},
+        m_metric{metric},
+        m_kernel{kernel},
+        m_staging{make_host_buffer<value_type[]>(queue, (Ndim + 1) * max_points)},
+        m_cluster_indexes{make_host_buffer<int[]>(queue, max_points)},
+        m_event_sizes{},
+        m_outputs{},
+        m_capacity{max_points},
+        m_size{0} {
+    if (max_points == 0) {
+      throw std::invalid_argument("The capacity of the batcher must be positive");
+    }
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline std::size_t EventBatcher<Ndim, TData, Kernel, DistanceMetric>::reserve(
+      Queue& queue, std::size_t event_size) {
+    if (event_size > m_capacity) {
+      throw std::invalid_argument("The event is larger than the capacity of the batcher");
+    }
+    if (m_size + event_size > m_capacity) {
+      flush(queue);
+    }
+    return m_size;
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void EventBatcher<Ndim, TData, Kernel, DistanceMetric>::append(std::size_t event_size,
+                                                                        const EventOutput& output) {
+    m_event_sizes.push_back(static_cast<uint32_t>(event_size));
+    m_outputs.push_back(output);
+    m_size += event_size;
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void EventBatcher<Ndim, TData, Kernel, DistanceMetric>::scatter(
+      std::span<const int> cluster_indexes) {
+    // the clusters of each event are numbered after the ones of the events preceding it
+    auto first = std::size_t{0};
+    auto cluster_offset = 0;
+    for (auto event = 0u; event < m_event_sizes.size(); ++event) {
+      const auto& output = m_outputs[event];
+      auto n_clusters = 0;
+      for (auto i = 0u; i < m_event_sizes[event]; ++i) {
+        const auto cluster = cluster_indexes[first + i];
+        output.cluster_indexes[i] = (cluster >= 0) ? cluster - cluster_offset : -1;
+        n_clusters = std::max(n_clusters, output.cluster_indexes[i] + 1);
+      }
+      if (output.n_clusters != nullptr)
+        *output.n_clusters = static_cast<std::size_t>(n_clusters);
+      if (output.points != nullptr)
+        internal::points_interface<PointsHost<Ndim, value_type>>::mark_clustered(*output.points);
+      first += m_event_sizes[event];
+      cluster_offset += n_clusters;
+    }
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void EventBatcher<Ndim, TData, Kernel, DistanceMetric>::push(
+      Queue& queue, PointsHost<Ndim, value_type>& event) {
+    const auto event_size = static_cast<std::size_t>(event.size());
+    if (event_size == 0) {
+      internal::points_interface<PointsHost<Ndim, value_type>>::mark_clustered(event);
+      return;
+    }
+    const auto offset = reserve(queue, event_size);
+    for (auto dim = 0u; dim < Ndim; ++dim)
+      std::ranges::copy(event.coords(dim), m_staging.data() + dim * m_capacity + offset);
+    std::ranges::copy(event.weights(), m_staging.data() + Ndim * m_capacity + offset);
+    append(event_size, EventOutput{event.view().cluster_index(), nullptr, &event});
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void EventBatcher<Ndim, TData, Kernel, DistanceMetric>::push(
+      Queue& queue,
+      std::span<const value_type> coordinates,
+      std::span<const value_type> weights,
+      std::span<int> cluster_indexes,
+      std::size_t* n_clusters) {
+    const auto event_size = weights.size();
+    if (coordinates.size() != Ndim * event_size || cluster_indexes.size() != event_size) {
+      throw std::invalid_argument(
+          "The sizes of the coordinates and of the cluster indexes must match the weights");
+    }
+    if (event_size == 0) {
+      if (n_clusters != nullptr)
+        *n_clusters = 0;
+      return;
+    }
+    const auto offset = reserve(queue, event_size);
+    for (auto dim = 0u; dim < Ndim; ++dim)
+      std::ranges::copy(coordinates.subspan(dim * event_size, event_size),
+                        m_staging.data() + dim * m_capacity + offset);
+    std::ranges::copy(weights, m_staging.data() + Ndim * m_capacity + offset);
+    append(event_size, EventOutput{cluster_indexes, n_clusters, nullptr});
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void EventBatcher<Ndim, TData, Kernel, DistanceMetric>::flush(Queue& queue) {
+    if (m_event_sizes.empty())
+      return;
+
+    // the staging rows have a stride of the full capacity, so the batch is built from one
+    // pointer per coordinate
+    const auto n_points = static_cast<int32_t>(m_size);
+    auto batch = [&]<std::size_t... Dims>(std::index_sequence<Dims...>) {
+      return PointsHost<Ndim, value_type>(queue,
+                                          n_points,
+                                          (m_staging.data() + Dims * m_capacity)...,
+                                          m_staging.data() + Ndim * m_capacity,
+                                          m_cluster_indexes.data());
+    }(std::make_index_sequence<Ndim>{});
+    PointsDevice<Ndim, value_type> d_batch(queue, n_points);
+
+    m_clusterer.make_clusters(queue,
+                              batch,
+                              d_batch,
+                              std::span<const uint32_t>{m_event_sizes},
+                              m_metric,
+                              m_kernel);
+    scatter(batch.clusterIndexes());
+
+    m_event_sizes.clear();
+    m_outputs.clear();
+    m_size = 0;
+  }
+
+}  // namespace clue
@@ -0,0 +1,169 @@
+
+#pragma once
+
+#include "CLUEstering/core/EventScheduler.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace clue {
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline EventScheduler<Ndim, TData>::EventScheduler(std::vector<Backend> backends) {
+    if (backends.empty()) {
+      throw std::invalid_argument("The scheduler must have at least one backend");
+    }
+    for (auto& backend : backends) {
+      if (backend.n_workers == 0 || !backend.process) {
+        throw std::invalid_argument(
+            "Each backend must have at least one worker and a function to process the events");
+      }
+      m_backends.push_back(std::make_unique<BackendState>(std::move(backend)));
+    }
+    for (auto& state : m_backends) {
+      for (auto worker = 0u; worker < state->backend.n_workers; ++worker)
+        state->threads.emplace_back([this, &state = *state, worker] { run(state, worker); });
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline EventScheduler<Ndim, TData>::~EventScheduler() {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    for (auto& state : m_backends) {
+      state->ready.notify_all();
+      for (auto& thread : state->threads) {
+        if (thread.joinable())
+          thread.join();
+      }
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void EventScheduler<Ndim, TData>::run(BackendState& state, std::size_t worker) {
+    std::unique_lock lock(m_mutex);
+    while (true) {
+      state.ready.wait(lock, [&] { return m_stop || !state.tasks.empty(); });
+      // the pending events are still clustered when the scheduler is stopped
+      if (state.tasks.empty())
+        return;
+
+      auto task = std::move(state.tasks.front());
+      state.tasks.pop_front();
+      lock.unlock();
+
+      const auto n_points = static_cast<std::size_t>(task.points->size());
+      const auto start = std::chrono::steady_clock::now();
+      std::exception_ptr error;
+      try {
+        state.backend.process(worker, *task.points);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+
+      lock.lock();
+      state.pending_time -= task.predicted_time;
+      --state.pending_events;
+      state.busy_time += elapsed;
+      if (!error) {
+        state.model.update(static_cast<double>(n_points),
+                           std::chrono::duration<double>(elapsed).count());
+        ++state.events;
+        state.points += n_points;
+        task.promise.set_value();
+      } else {
+        task.promise.set_exception(error);
+      }
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline std::optional<double> EventScheduler<Ndim, TData>::predict(const BackendState& state,
+                                                                     std::size_t n_points) const {
+    if (!state.model.ready())
+      return std::nullopt;
+    return state.model.predict(static_cast<double>(n_points));
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline auto EventScheduler<Ndim, TData>::choose_backend(std::size_t n_points,
+                                                          double& predicted_time)
+      -> BackendState& {
+    // a backend that has never been measured gets an event as soon as one of its workers is idle
+    for (auto& state : m_backends) {
+      if (!state->model.ready() && state->pending_events < state->backend.n_workers) {
+        predicted_time = 0.;
+        return *state;
+      }
+    }
+
+    // the backends not measured yet are assumed to be as slow as the slowest measured one
+    auto slowest = std::optional<double>{};
+    for (const auto& state : m_backends) {
+      if (const auto time = predict(*state, n_points))
+        slowest = std::max(slowest.value_or(0.), *time);
+    }
+
+    BackendState* best = nullptr;
+    auto best_completion = std::numeric_limits<double>::max();
+    for (auto& state : m_backends) {
+      const auto time = predict(*state, n_points).value_or(slowest.value_or(1.));
+      const auto completion =
+          (state->pending_time + time) / static_cast<double>(state->backend.n_workers);
+      if (completion < best_completion) {
+        best = state.get();
+        best_completion = completion;
+        predicted_time = time;
+      }
+    }
+    return *best;
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline std::future<void> EventScheduler<Ndim, TData>::submit(
+      PointsHost<Ndim, value_type>& points) {
+    std::promise<void> promise;
+    auto future = promise.get_future();
+
+    std::lock_guard lock(m_mutex);
+    auto predicted_time = 0.;
+    auto& state = choose_backend(static_cast<std::size_t>(points.size()), predicted_time);
+    state.pending_time += predicted_time;
+    ++state.pending_events;
+    state.tasks.push_back(Task{&points, predicted_time, std::move(promise)});
+    state.ready.notify_one();
+    return future;
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline auto EventScheduler<Ndim, TData>::statistics() const -> std::vector<BackendStatistics> {
+    std::lock_guard lock(m_mutex);
+    std::vector<BackendStatistics> statistics;
+    statistics.reserve(m_backends.size());
+    for (const auto& state : m_backends) {
+      const auto busy_time = std::chrono::duration<double>(state->busy_time).count();
+      statistics.push_back(BackendStatistics{state->backend.name,
+                                             state->events,
+                                             state->points,
+                                             busy_time,
+                                             (busy_time > 0.) ? state->points / busy_time : 0.});
+    }
+    return statistics;
+  }
+
+}  // namespace clue
@@ -0,0 +1,140 @@
+
+#pragma once
+
+#include "CLUEstering/core/ExecutionResources.hpp"
+#include "CLUEstering/core/detail/defines.hpp"
+#include "CLUEstering/internal/alpaka/exec.hpp"
+
+#include <alpaka/alpaka.hpp>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#if defined(CLUE_TBB_EXECUTION_SCOPE)
+#include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_scheduler_observer.h>
+#elif defined(CLUE_OMP_EXECUTION_SCOPE)
+#include <omp.h>
+#endif
+
+namespace clue::detail {
+
+  // Pins the calling thread to the given cores
+  inline void pin_thread(std::span<const int> cores) {
+#ifdef __linux__
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    for (auto core : cores)
+      CPU_SET(core, &affinity);
+    sched_setaffinity(0, sizeof(affinity), &affinity);
+#endif
+  }
+
+  // Restores the affinity of the calling thread when going out of scope
+  class AffinityGuard {
+#ifdef __linux__
+    cpu_set_t m_affinity;
+    bool m_saved = false;
+#endif
+
+  public:
+    AffinityGuard() {
+#ifdef __linux__
+      m_saved = sched_getaffinity(0, sizeof(m_affinity), &m_affinity) == 0;
+#endif
+    }
+    AffinityGuard(const AffinityGuard&) = delete;
+    AffinityGuard& operator=(const AffinityGuard&) = delete;
+    ~AffinityGuard() {
+#ifdef __linux__
+      if (m_saved)
+        sched_setaffinity(0, sizeof(m_affinity), &m_affinity);
+#endif
+    }
+  };
+
+#ifdef CLUE_TBB_EXECUTION_SCOPE
+  // Pins each thread entering the arena to one of the cores
+  class PinningObserver : public tbb::task_scheduler_observer {
+    std::span<const int> m_cores;
+
+  public:
+    PinningObserver(tbb::task_arena& arena, std::span<const int> cores)
+        : tbb::task_scheduler_observer{arena}, m_cores{cores} {
+      observe(true);
+    }
+    ~PinningObserver() override { observe(false); }
+
+    void on_scheduler_entry(bool) override {
+      const auto slot = static_cast<std::size_t>(tbb::this_task_arena::current_thread_index());
+      pin_thread(m_cores.subspan(slot % m_cores.size(), 1));
+    }
+  };
+#endif
+
+  // Applies the execution resources of a Clusterer to the kernels launched while it is alive
+  class ExecutionScope {
+    Queue& m_queue;
+    std::optional<AffinityGuard> m_affinity;
+#if defined(CLUE_TBB_EXECUTION_SCOPE)
+    // the observer is declared after the arena so that it stops observing it first
+    std::optional<tbb::task_arena> m_arena;
+    std::optional<PinningObserver> m_observer;
+    tbb::task_arena* m_previous_arena = nullptr;
+#elif defined(CLUE_OMP_EXECUTION_SCOPE)
+    std::optional<int> m_previous_threads;
+#endif
+
+  public:
+    ExecutionScope(Queue& queue, const ExecutionResources& resources) : m_queue{queue} {
+      const std::span<const int> cores{resources.cores};
+      if (!cores.empty())
+        m_affinity.emplace();
+#if defined(CLUE_TBB_EXECUTION_SCOPE)
+      // the kernels launched while the scope is alive run in its own arena, so that other
+      // clusterers and the rest of the application keep the default TBB parallelism
+      if (resources.n_threads > 0 || !cores.empty()) {
+        m_arena.emplace(resources.n_threads > 0 ? static_cast<int>(resources.n_threads)
+                                                : tbb::task_arena::automatic);
+        if (!cores.empty())
+          m_observer.emplace(*m_arena, cores);
+        m_previous_arena = std::exchange(internal::current_arena, &m_arena.value());
+      }
+#elif defined(CLUE_OMP_EXECUTION_SCOPE)
+      if (resources.n_threads > 0) {
+        m_previous_threads = omp_get_max_threads();
+        omp_set_num_threads(static_cast<int>(resources.n_threads));
+      }
+      if (!cores.empty()) {
+        // the threads of the team are reused by the parallel regions of the kernels
+#pragma omp parallel
+        pin_thread(cores.subspan(omp_get_thread_num() % cores.size(), 1));
+      }
+#else
+      // the kernels run on the calling thread, or on a device
+      if (!cores.empty())
+        pin_thread(cores);
+#endif
+    }
+    ExecutionScope(const ExecutionScope&) = delete;
+    ExecutionScope& operator=(const ExecutionScope&) = delete;
+    ~ExecutionScope() {
+#if defined(CLUE_TBB_EXECUTION_SCOPE)
+      // the queue is non-blocking, so the kernels enqueued in the arena have to complete before
+      // it is destroyed
+      alpaka::wait(m_queue);
+      if (m_arena.has_value())
+        internal::current_arena = m_previous_arena;
+#elif defined(CLUE_OMP_EXECUTION_SCOPE)
+      if (m_previous_threads.has_value())
+        omp_set_num_threads(*m_previous_threads);
+#endif
+    }
+  };
+
+}  // namespace clue::detail
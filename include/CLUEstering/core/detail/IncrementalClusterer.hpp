@@ -0,0 +1,209 @@
+
+#pragma once
+
+#include "CLUEstering/core/IncrementalClusterer.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace clue {
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline IncrementalClusterer<Ndim, TData, Kernel, DistanceMetric>::IncrementalClusterer(
+      Queue& queue,
+      value_type density_radius,
+      value_type min_density,
+      std::optional<value_type> outlier_distance,
+      std::optional<value_type> seeding_distance,
+      const DistanceMetric& metric,
+      const Kernel& kernel)
+      : m_clusterer{queue, density_radius, min_density, outlier_distance, seeding_distance},
+        m_metric{metric},
+        m_kernel{kernel},
+        m_dev_points{},
+        m_n_clusters{0},
+        m_updated_points{0} {}
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void IncrementalClusterer<Ndim, TData, Kernel, DistanceMetric>::recluster(Queue& queue) {
+    const auto n_points = m_points.size();
+    m_cluster_index.resize(n_points);
+    if (n_points == 0) {
+      m_dev_points.reset();
+      m_n_clusters = 0;
+      m_updated_points = 0;
+      return;
+    }
+
+    m_input.resize((Ndim + 1) * n_points);
+    for (auto i = 0u; i < n_points; ++i) {
+      for (auto dim = 0u; dim <= Ndim; ++dim)
+        m_input[dim * n_points + i] = m_points[i][dim];
+    }
+    PointsHost<Ndim, value_type> h_points(
+        queue, static_cast<int32_t>(n_points), m_input.data(), m_cluster_index.data());
+    // the slots are the same of the last update only if their number didn't change
+    if (m_dev_points.has_value() && static_cast<std::size_t>(m_dev_points->size()) == n_points) {
+      m_updated_points =
+          m_clusterer.update_positions(queue, h_points, *m_dev_points, m_metric, m_kernel);
+    } else {
+      m_dev_points.emplace(queue, static_cast<int32_t>(n_points));
+      m_clusterer.make_clusters(queue, h_points, *m_dev_points, m_metric, m_kernel);
+      m_updated_points = n_points;
+    }
+    m_n_clusters = h_points.n_clusters();
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline std::vector<int32_t> IncrementalClusterer<Ndim, TData, Kernel, DistanceMetric>::update(
+      Queue& queue,
+      std::span<const int32_t> removed,
+      std::span<const value_type> coordinates,
+      std::span<const value_type> weights) {
+    const auto n_inserted = weights.size();
+    if (coordinates.size() != Ndim * n_inserted) {
+      throw std::invalid_argument(
+          "The number of coordinates doesn't match the number of inserted points");
+    }
+    std::vector<int32_t> free_slots;
+    free_slots.reserve(removed.size());
+    for (auto point : removed) {
+      if (!contains(point)) {
+        throw std::invalid_argument("The removed points must be distinct points of the clusterer");
+      }
+      free_slots.push_back(m_slots[point]);
+    }
+    std::ranges::sort(free_slots, std::greater{});
+    if (std::ranges::adjacent_find(free_slots) != free_slots.end()) {
+      throw std::invalid_argument("The removed points must be distinct points of the clusterer");
+    }
+    for (auto point : removed) {
+      m_slots[point] = -1;
+      m_free_indexes.push_back(point);
+    }
+
+    // the inserted points take the slots of the removed ones first
+    std::vector<int32_t> inserted(n_inserted);
+    for (auto i = 0u; i < n_inserted; ++i) {
+      Point<Ndim, value_type> point;
+      for (auto dim = 0u; dim != Ndim; ++dim)
+        point[dim] = coordinates[dim * n_inserted + i];
+      point[Ndim] = weights[i];
+
+      int32_t index;
+      if (m_free_indexes.empty()) {
+        index = static_cast<int32_t>(m_slots.size());
+        m_slots.push_back(-1);
+      } else {
+        index = m_free_indexes.back();
+        m_free_indexes.pop_back();
+      }
+      int32_t slot;
+      if (free_slots.empty()) {
+        slot = static_cast<int32_t>(m_points.size());
+        m_points.push_back(point);
+        m_indexes.push_back(index);
+      } else {
+        slot = free_slots.back();
+        free_slots.pop_back();
+        m_points[slot] = point;
+        m_indexes[slot] = index;
+      }
+      m_slots[index] = slot;
+      inserted[i] = index;
+    }
+
+    // the slots left free, from the last, are filled with the last points
+    for (auto slot : free_slots) {
+      const auto last = static_cast<int32_t>(m_points.size()) - 1;
+      if (slot != last) {
+        m_points[slot] = m_points[last];
+        m_indexes[slot] = m_indexes[last];
+        m_slots[m_indexes[slot]] = slot;
+      }
+      m_points.pop_back();
+      m_indexes.pop_back();
+    }
+
+    recluster(queue);
+    return inserted;
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline int32_t IncrementalClusterer<Ndim, TData, Kernel, DistanceMetric>::cluster_index(
+      int32_t point) const {
+    if (!contains(point)) {
+      throw std::invalid_argument("The point is not in the clusterer");
+    }
+    return m_cluster_index[m_slots[point]];
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline SlidingWindow<Ndim, TData, Kernel, DistanceMetric>::SlidingWindow(Clusterer& clusterer,
+                                                                          std::size_t capacity)
+      : m_clusterer{clusterer}, m_window{}, m_capacity{capacity} {
+    if (capacity == 0) {
+      throw std::invalid_argument("The capacity of the window must be positive");
+    }
+    if (clusterer.size() != 0) {
+      throw std::invalid_argument("The clusterer of the window must be empty");
+    }
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline std::vector<int32_t> SlidingWindow<Ndim, TData, Kernel, DistanceMetric>::push(
+      Queue& queue, std::span<const value_type> coordinates, std::span<const value_type> weights) {
+    const auto n_points = weights.size();
+    if (n_points > m_capacity) {
+      throw std::invalid_argument("The batch is larger than the capacity of the window");
+    }
+    const auto n_evicted =
+        (m_window.size() + n_points > m_capacity) ? m_window.size() + n_points - m_capacity : 0;
+    const std::vector<int32_t> evicted(m_window.begin(),
+                                       m_window.begin() + static_cast<std::ptrdiff_t>(n_evicted));
+    auto inserted = m_clusterer.update(queue, evicted, coordinates, weights);
+    m_window.erase(m_window.begin(), m_window.begin() + static_cast<std::ptrdiff_t>(n_evicted));
+    m_window.insert(m_window.end(), inserted.begin(), inserted.end());
+    return inserted;
+  }
+
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel Kernel,
+            concepts::distance_metric<Ndim> DistanceMetric>
+  inline void SlidingWindow<Ndim, TData, Kernel, DistanceMetric>::evict(Queue& queue,
+                                                                        std::size_t n_points) {
+    const auto n_evicted = std::min(n_points, m_window.size());
+    const std::vector<int32_t> evicted(m_window.begin(),
+                                       m_window.begin() + static_cast<std::ptrdiff_t>(n_evicted));
+    m_clusterer.remove(queue, evicted);
+    m_window.erase(m_window.begin(), m_window.begin() + static_cast<std::ptrdiff_t>(n_evicted));
+  }
+
+}  // namespace clue
@@ -0,0 +1,352 @@
+
+#pragma once
+
+#include "CLUEstering/core/ConvolutionalKernel.hpp"
+#include "CLUEstering/core/DistanceMetrics.hpp"
+#include "CLUEstering/core/detail/ClusteringKernels.hpp"
+#include "CLUEstering/data_structures/internal/PointsCommon.hpp"
+#include "CLUEstering/data_structures/internal/SearchBox.hpp"
+#include "CLUEstering/data_structures/internal/TilesView.hpp"
+#include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/detail/make_array.hpp"
+#include "CLUEstering/internal/algorithm/scan/scan.hpp"
+#include "CLUEstering/internal/alpaka/exec.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+#include "CLUEstering/internal/alpaka/work_division.hpp"
+#include "CLUEstering/internal/nostd/ceil_div.hpp"
+
+#include <alpaka/alpaka.hpp>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+namespace clue::detail {
+
+  // The neighbours of each point within a radius, in CSR format, with their distances. The list
+  // of each point includes the point itself.
+  template <concepts::device TDev, std::floating_point TData>
+  struct NeighbourLists {
+    clue::device_buffer<TDev, std::size_t[]> offsets;
+    clue::device_buffer<TDev, int32_t[]> indexes;
+    clue::device_buffer<TDev, TData[]> distances;
+    TData radius;
+    std::size_t n_points;
+  };
+
+  // The lists replace the search in the tiles only when they hold the same points, that is for
+  // the metrics never smaller than the difference along a single coordinate
+  template <typename DistanceMetric>
+  inline constexpr bool supports_neighbour_lists_v = is_coordinate_bounded_metric_v<DistanceMetric>;
+
+  // Calls a function on each point within a radius of a point, with its distance
+  template <std::size_t Ndim,
+            std::floating_point TData,
+            std::floating_point TPointsData,
+            concepts::distance_metric<Ndim> DistanceMetric,
+            typename TFunc>
+  ALPAKA_FN_ACC void for_each_neighbour(internal::TilesView<Ndim, TData>& tiles,
+                                        const PointsView<Ndim, TPointsData>& points,
+                                        int32_t point_id,
+                                        TData radius,
+                                        const DistanceMetric& metric,
+                                        TFunc& func) {
+    const auto coords_i = points[point_id];
+    clue::SearchBoxExtremes<Ndim, TData> searchbox_extremes;
+    for (auto dim = 0u; dim != Ndim; ++dim) {
+      searchbox_extremes[dim] =
+          clue::nostd::make_array(coords_i[dim] - radius, coords_i[dim] + radius);
+    }
+    clue::SearchBoxBins<Ndim> searchbox_bins;
+    tiles.searchBox(searchbox_extremes, searchbox_bins);
+
+    const bool windowed = use_sorted_window<DistanceMetric>(tiles);
+    auto visit_tile = [&](int32_t tile_idx) {
+      const auto tile = tiles[tile_idx];
+      const auto first = windowed ? sorted_window_begin(tile, points, coords_i[0] - radius)
+                                  : std::size_t{0};
+      for (auto tile_it = first; tile_it < tile.size(); ++tile_it) {
+        const auto j = tile[tile_it];
+        if (windowed && points.coords()[0][j] > coords_i[0] + radius)
+          break;
+        const auto distance = metric(coords_i, points[j]);
+        if (distance <= radius)
+          func(j, distance);
+      }
+    };
+    std::array<int32_t, Ndim> base_vec{};
+    for_each_tile<Ndim, Ndim>(base_vec, searchbox_bins, tiles, visit_tile);
+  }
+
+  struct KernelCountNeighbours {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              concepts::distance_metric<Ndim> DistanceMetric,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> tiles,
+                                  PointsView<Ndim, TPointsData> points,
+                                  TData radius,
+                                  DistanceMetric metric,
+                                  std::size_t* counts) const {
+      for (auto i : alpaka::uniformElements(acc, points.size())) {
+        std::size_t n_neighbours = 0;
+        auto count = [&](int32_t, TData) { ++n_neighbours; };
+        for_each_neighbour(tiles, points, static_cast<int32_t>(i), radius, metric, count);
+        counts[i] = n_neighbours;
+      }
+    }
+  };
+
+  struct KernelFillNeighbours {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              concepts::distance_metric<Ndim> DistanceMetric,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  internal::TilesView<Ndim, TData> tiles,
+                                  PointsView<Ndim, TPointsData> points,
+                                  TData radius,
+                                  DistanceMetric metric,
+                                  const std::size_t* offsets,
+                                  int32_t* indexes,
+                                  TData* distances) const {
+      for (auto i : alpaka::uniformElements(acc, points.size())) {
+        auto position = offsets[i];
+        auto store = [&](int32_t j, TData distance) {
+          indexes[position] = j;
+          distances[position] = distance;
+          ++position;
+        };
+        for_each_neighbour(tiles, points, static_cast<int32_t>(i), radius, metric, store);
+      }
+    }
+  };
+
+  struct KernelNeighbourListDensity {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              concepts::convolutional_kernel KernelType,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim, TPointsData> points,
+                                  const std::size_t* offsets,
+                                  const int32_t* indexes,
+                                  const TData* distances,
+                                  const KernelType& kernel,
+                                  TData density_radius,
+                                  TData min_density,
+                                  int32_t* active) const {
+      for (auto i : alpaka::uniformElements(acc, points.size())) {
+        auto rho_i = static_cast<TData>(0.);
+        bool has_neighbours = false;
+        for (auto k = offsets[i]; k < offsets[i + 1]; ++k) {
+          const auto j = indexes[k];
+          const auto distance = distances[k];
+          if (distance <= density_radius) {
+            rho_i += kernel(distance, static_cast<int32_t>(i), j) * points.weights()[j];
+            has_neighbours = has_neighbours || j != static_cast<int32_t>(i);
+          }
+        }
+
+        points.rho()[i] = rho_i;
+        if (active != nullptr) {
+          active[i] = has_neighbours;
+          if (!has_neighbours)
+            mark_isolated_point(points, static_cast<int32_t>(i), rho_i, min_density);
+        }
+      }
+    }
+  };
+
+  struct KernelNeighbourListNearestHigher {
+    template <typename TAcc,
+              std::size_t Ndim,
+              std::floating_point TData,
+              std::floating_point TPointsData = TData>
+      requires(alpaka::Dim<TAcc>::value == 1)
+    ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                  PointsView<Ndim, TPointsData> points,
+                                  const std::size_t* offsets,
+                                  const int32_t* indexes,
+                                  const TData* distances,
+                                  TData outlier_distance,
+                                  TData seeding_distance,
+                                  TData min_density,
+                                  const int32_t* active_points,
+                                  std::size_t n_active) const {
+      auto tag = [&points](std::integral auto idx) -> std::size_t {
+        return (points.has_tags()) ? points.tags()[idx] : static_cast<std::size_t>(idx);
+      };
+
+      const auto n_points = (active_points != nullptr) ? n_active : points.size();
+      for (auto k : alpaka::uniformElements(acc, n_points)) {
+        const auto i = (active_points != nullptr) ? static_cast<decltype(k)>(active_points[k]) : k;
+        auto delta_i = std::numeric_limits<TData>::max();
+        int nh_i = -1;
+        const auto rho_i = points.rho()[i];
+        const auto point_tag = tag(i);
+        const auto density_uncertainty =
+            points.has_uncertainty() ? points.density_uncertainty()[i] : TData{1.};
+        const auto effective_min_density = min_density * density_uncertainty;
+        const auto effective_distance =
+            (rho_i >= effective_min_density) ? seeding_distance : outlier_distance;
+
+        // the same rules of the search in the tiles, including the choice between equidistant
+        // nearest-highers, so that the result doesn't depend on the order of the list
+        for (auto n = offsets[i]; n < offsets[i + 1]; ++n) {
+          const auto j = indexes[n];
+          const auto distance = distances[n];
+          const auto rho_j = points.rho()[j];
+          const auto tag_j = tag(j);
+          const bool higher = (rho_j > rho_i) || ((rho_j == rho_i) && (rho_j > TData{0}) &&
+                                                  (tag_j > point_tag));
+          if (higher && distance <= effective_distance &&
+              ((distance < delta_i) ||
+               ((distance == delta_i) && (nh_i >= 0) &&
+                ((rho_j > points.rho()[nh_i]) ||
+                 ((rho_j == points.rho()[nh_i]) && (tag_j > tag(nh_i))))))) {
+            delta_i = distance;
+            nh_i = j;
+          }
+        }
+
+        points.nearest_higher()[i] = nh_i;
+        points.cluster_index()[i] = -1;
+        points.is_seed()[i] = (nh_i == -1) && (rho_i >= effective_min_density);
+      }
+    }
+  };
+
+  // Builds the neighbour lists of the points within a radius, counting the neighbours of each
+  // point before storing them. No lists are built if they would take more than max_bytes.
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            concepts::distance_metric<Ndim> DistanceMetric,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1 &&
+             std::same_as<std::remove_cv_t<TPointsData>, std::remove_cv_t<TData>>)
+  inline std::optional<NeighbourLists<alpaka::Dev<TQueue>, TData>> buildNeighbourLists(
+      TQueue& queue,
+      std::size_t block_size,
+      const internal::TilesView<Ndim, TData>& tiles,
+      const PointsView<Ndim, TPointsData>& points,
+      TData radius,
+      const DistanceMetric& metric,
+      std::size_t max_bytes) {
+    const auto n_points = static_cast<std::size_t>(points.size());
+    const Idx grid_size = nostd::ceil_div(n_points, block_size);
+    const auto work_division = clue::make_workdiv<TAcc>(grid_size, block_size);
+
+    auto offsets = clue::make_device_buffer<std::size_t[]>(queue, n_points + 1);
+    alpaka::memset(queue, clue::make_device_view(alpaka::getDev(queue), offsets.data(), 1), 0);
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelCountNeighbours{},
+                         tiles,
+                         points,
+                         radius,
+                         metric,
+                         offsets.data() + 1);
+    internal::algorithm::inclusive_scan(
+        queue, offsets.data() + 1, offsets.data() + n_points + 1, offsets.data() + 1);
+
+    auto n_neighbours = std::size_t{0};
+    alpaka::memcpy(
+        queue,
+        clue::make_host_view(n_neighbours),
+        clue::make_device_view(alpaka::getDev(queue), offsets.data() + n_points, 1u));
+    alpaka::wait(queue);
+    if (n_neighbours > max_bytes / (sizeof(int32_t) + sizeof(TData)))
+      return std::nullopt;
+
+    auto indexes = clue::make_device_buffer<int32_t[]>(queue, n_neighbours);
+    auto distances = clue::make_device_buffer<TData[]>(queue, n_neighbours);
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelFillNeighbours{},
+                         tiles,
+                         points,
+                         radius,
+                         metric,
+                         offsets.data(),
+                         indexes.data(),
+                         distances.data());
+    return NeighbourLists<alpaka::Dev<TQueue>, TData>{
+        std::move(offsets), std::move(indexes), std::move(distances), radius, n_points};
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            concepts::convolutional_kernel KernelType,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1)
+  inline void computeLocalDensityFromNeighbours(
+      TQueue& queue,
+      const WorkDiv& work_division,
+      const NeighbourLists<alpaka::Dev<TQueue>, TData>& neighbours,
+      PointsView<Ndim, TPointsData>& points,
+      const KernelType& kernel,
+      TData density_radius,
+      TData min_density,
+      int32_t* active) {
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelNeighbourListDensity{},
+                         points,
+                         neighbours.offsets.data(),
+                         neighbours.indexes.data(),
+                         neighbours.distances.data(),
+                         kernel,
+                         density_radius,
+                         min_density,
+                         active);
+  }
+
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TData,
+            std::floating_point TPointsData = TData>
+    requires(alpaka::Dim<TAcc>::value == 1)
+  inline void computeNearestHighersFromNeighbours(
+      TQueue& queue,
+      const WorkDiv& work_division,
+      const NeighbourLists<alpaka::Dev<TQueue>, TData>& neighbours,
+      PointsView<Ndim, TPointsData>& points,
+      TData outlier_distance,
+      TData seeding_distance,
+      TData min_density,
+      const int32_t* active_points = nullptr,
+      std::size_t n_active = 0) {
+    if (active_points != nullptr && n_active == 0)
+      return;
+
+    internal::exec<TAcc>(queue,
+                         work_division,
+                         KernelNeighbourListNearestHigher{},
+                         points,
+                         neighbours.offsets.data(),
+                         neighbours.indexes.data(),
+                         neighbours.distances.data(),
+                         outlier_distance,
+                         seeding_distance,
+                         min_density,
+                         active_points,
+                         n_active);
+  }
+
+}  // namespace clue::detail
@@ -0,0 +1,389 @@
+
+#pragma once
+
+#include "CLUEstering/core/OutOfCoreClusterer.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/internal/alpaka/devices.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+#include "CLUEstering/internal/io/mapped_file.hpp"
+
+#include <alpaka/alpaka.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace clue {
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline std::size_t OutOfCoreClusterer<Ndim, TData>::Binning::bin(value_type coordinate) const {
+    const auto position = static_cast<std::size_t>((coordinate - min) / width);
+    return std::min(position, n_bins - 1);
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline OutOfCoreClusterer<Ndim, TData>::Slot::Slot(const Device& device,
+                                                     std::size_t capacity,
+                                                     value_type density_radius,
+                                                     value_type min_density,
+                                                     std::optional<value_type> outlier_distance,
+                                                     std::optional<value_type> seeding_distance)
+      : queue{device},
+        clusterer{queue, density_radius, min_density, outlier_distance, seeding_distance},
+        h_buffer{make_host_buffer<std::byte[]>(
+            queue, soa::host::computeSoASize<Ndim, value_type>(static_cast<int32_t>(capacity)))},
+        d_buffer{make_device_buffer<std::byte[]>(
+            queue,
+            soa::device::computeSoASize<Ndim, value_type>(static_cast<int32_t>(capacity)))},
+        nearest_higher{},
+        is_seed{},
+        owned{},
+        chunk{0},
+        result{} {}
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline OutOfCoreClusterer<Ndim, TData>::OutOfCoreClusterer(
+      const Device& device,
+      std::size_t chunk_points,
+      std::size_t n_buffers,
+      value_type density_radius,
+      value_type min_density,
+      std::optional<value_type> outlier_distance,
+      std::optional<value_type> seeding_distance)
+      : m_slots{},
+        m_chunks{},
+        m_pending{},
+        m_capacity{chunk_points},
+        m_n_bins{1 << 16},
+        m_halo_width{density_radius + std::max(outlier_distance.value_or(density_radius),
+                                               seeding_distance.value_or(density_radius))},
+        m_n_clusters{0} {
+    if (chunk_points == 0 ||
+        chunk_points > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()) ||
+        n_buffers == 0) {
+      throw std::invalid_argument(
+          "The chunks must hold at least one point and at most 2^31 - 1, and at least one buffer "
+          "is needed");
+    }
+    m_slots.reserve(n_buffers);
+    for (auto i = 0u; i < n_buffers; ++i) {
+      m_slots.push_back(std::make_unique<Slot>(
+          device, chunk_points, density_radius, min_density, outlier_distance, seeding_distance));
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline OutOfCoreClusterer<Ndim, TData>::OutOfCoreClusterer(
+      std::size_t chunk_points,
+      std::size_t n_buffers,
+      value_type density_radius,
+      value_type min_density,
+      std::optional<value_type> outlier_distance,
+      std::optional<value_type> seeding_distance)
+      : OutOfCoreClusterer(devices<Platform>().front(),
+                           chunk_points,
+                           n_buffers,
+                           density_radius,
+                           min_density,
+                           outlier_distance,
+                           seeding_distance) {}
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void OutOfCoreClusterer<Ndim, TData>::setHistogramBins(std::size_t n_bins) {
+    if (n_bins == 0) {
+      throw std::invalid_argument("The histogram must have at least one bin");
+    }
+    m_n_bins = n_bins;
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline auto OutOfCoreClusterer<Ndim, TData>::make_binning(std::span<const value_type> points,
+                                                            std::size_t n_points) const
+      -> Binning {
+    std::array<value_type, Ndim> min, max;
+    min.fill(std::numeric_limits<value_type>::max());
+    max.fill(std::numeric_limits<value_type>::lowest());
+    for (auto i = 0u; i < n_points; ++i) {
+      for (auto dim = 0u; dim < Ndim; ++dim) {
+        min[dim] = std::min(min[dim], points[i * (Ndim + 1) + dim]);
+        max[dim] = std::max(max[dim], points[i * (Ndim + 1) + dim]);
+      }
+    }
+
+    // the chunks are cut along the axis where the points are most spread
+    auto axis = 0u;
+    for (auto dim = 1u; dim < Ndim; ++dim) {
+      if (max[dim] - min[dim] > max[axis] - min[axis])
+        axis = dim;
+    }
+    const auto extent = max[axis] - min[axis];
+    if (extent <= value_type{0})
+      return Binning{axis, min[axis], value_type{1}, 1};
+    return Binning{axis, min[axis], extent / static_cast<value_type>(m_n_bins), m_n_bins};
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void OutOfCoreClusterer<Ndim, TData>::make_chunks(std::span<const value_type> points,
+                                                           std::size_t n_points,
+                                                           const Binning& binning) {
+    std::vector<std::size_t> counts(binning.n_bins + 1, 0);
+    for (auto i = 0u; i < n_points; ++i)
+      ++counts[binning.bin(points[i * (Ndim + 1) + binning.axis]) + 1];
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+    // one more bin absorbs the rounding of the bin edges
+    const auto halo_bins = static_cast<std::size_t>(std::ceil(m_halo_width / binning.width)) + 1;
+    auto halo_begin = [&](std::size_t bin) { return (bin > halo_bins) ? bin - halo_bins : 0; };
+    auto halo_end = [&](std::size_t bin) { return std::min(bin + halo_bins, binning.n_bins); };
+    auto count = [&](std::size_t begin, std::size_t end) { return counts[end] - counts[begin]; };
+
+    m_chunks.clear();
+    std::size_t offset = 0;
+    for (std::size_t first = 0; first < binning.n_bins;) {
+      auto last = first + 1;
+      if (count(halo_begin(first), halo_end(last)) > m_capacity) {
+        throw std::runtime_error(
+            "The points around a bin and its halo don't fit in a chunk, the chunks must be larger");
+      }
+      while (last < binning.n_bins && count(halo_begin(first), halo_end(last + 1)) <= m_capacity)
+        ++last;
+
+      const auto size = count(halo_begin(first), halo_end(last));
+      m_chunks.push_back(Chunk{first,
+                               last,
+                               halo_begin(first),
+                               halo_end(last),
+                               offset,
+                               size,
+                               count(first, last)});
+      offset += size;
+      first = last;
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void OutOfCoreClusterer<Ndim, TData>::fill_indexes(std::span<const value_type> points,
+                                                            std::size_t n_points,
+                                                            const Binning& binning,
+                                                            std::span<int64_t> indexes) const {
+    std::vector<std::size_t> owner(binning.n_bins);
+    for (auto c = 0u; c < m_chunks.size(); ++c)
+      std::fill(owner.begin() + m_chunks[c].first_bin, owner.begin() + m_chunks[c].last_bin, c);
+
+    // the indexes of each chunk are written in increasing order, so that ties in density are
+    // broken as if the whole dataset was clustered at once
+    std::vector<std::size_t> cursors(m_chunks.size());
+    std::ranges::transform(m_chunks, cursors.begin(), [](const auto& chunk) {
+      return chunk.offset;
+    });
+    for (auto i = 0u; i < n_points; ++i) {
+      const auto bin = binning.bin(points[i * (Ndim + 1) + binning.axis]);
+      auto contains = [&](std::size_t c) {
+        return bin >= m_chunks[c].first_halo_bin && bin < m_chunks[c].last_halo_bin;
+      };
+      auto first = owner[bin];
+      while (first > 0 && contains(first - 1))
+        --first;
+      for (auto c = first; c < m_chunks.size() && contains(c); ++c)
+        indexes[cursors[c]++] = static_cast<int64_t>(i);
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  template <concepts::convolutional_kernel Kernel, concepts::distance_metric<Ndim> DistanceMetric>
+  inline void OutOfCoreClusterer<Ndim, TData>::cluster_chunk(Slot& slot,
+                                                             std::span<const value_type> points,
+                                                             std::span<const int64_t> indexes,
+                                                             const Binning& binning,
+                                                             const DistanceMetric& metric,
+                                                             const Kernel& kernel) const {
+    const auto& chunk = m_chunks[slot.chunk];
+    const auto size = static_cast<int32_t>(chunk.size);
+    PointsHost<Ndim, value_type> h_points(
+        slot.queue,
+        size,
+        std::span<std::byte>(slot.h_buffer.data(),
+                             soa::host::computeSoASize<Ndim, value_type>(size)));
+    slot.owned.resize(chunk.size);
+    for (auto k = 0u; k < chunk.size; ++k) {
+      const auto* point = points.data() + indexes[k] * (Ndim + 1);
+      for (auto dim = 0u; dim < Ndim; ++dim)
+        h_points.coords(dim)[k] = point[dim];
+      h_points.weights()[k] = point[Ndim];
+      const auto bin = binning.bin(point[binning.axis]);
+      slot.owned[k] = bin >= chunk.first_bin && bin < chunk.last_bin;
+    }
+
+    PointsDevice<Ndim, value_type> d_points(
+        slot.queue,
+        size,
+        std::span<std::byte>(slot.d_buffer.data(),
+                             soa::device::computeSoASize<Ndim, value_type>(size)));
+    slot.clusterer.make_clusters(slot.queue, h_points, d_points, metric, kernel);
+
+    slot.nearest_higher.resize(chunk.size);
+    slot.is_seed.resize(chunk.size);
+    const auto device = alpaka::getDev(slot.queue);
+    alpaka::memcpy(slot.queue,
+                   make_host_view(slot.nearest_higher.data(), size),
+                   make_device_view(device, d_points.view().m_nearest_higher, size));
+    alpaka::memcpy(slot.queue,
+                   make_host_view(slot.is_seed.data(), size),
+                   make_device_view(device, d_points.view().m_is_seed, size));
+    alpaka::wait(slot.queue);
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void OutOfCoreClusterer<Ndim, TData>::assign_chunk(Slot& slot,
+                                                            std::span<const int64_t> indexes,
+                                                            std::span<int32_t> labels) {
+    constexpr int32_t unresolved = -2;
+    constexpr int32_t pending = -3;
+    const auto size = m_chunks[slot.chunk].size;
+
+    std::vector<int32_t> local(size, unresolved);
+    std::vector<int64_t> exits(size, -1);
+    for (auto k = 0u; k < size; ++k) {
+      if (slot.owned[k] && slot.is_seed[k])
+        local[k] = m_n_clusters++;
+    }
+
+    // the follower chains are followed while they stay in the chunk, and the ones reaching a
+    // point of the halo are completed when the chunk owning it has been clustered
+    std::vector<std::size_t> chain;
+    for (auto k = 0u; k < size; ++k) {
+      if (!slot.owned[k])
+        continue;
+      chain.clear();
+      auto current = k;
+      auto label = int32_t{-1};
+      auto exit = int64_t{-1};
+      while (true) {
+        if (local[current] != unresolved) {
+          label = local[current];
+          exit = exits[current];
+          break;
+        }
+        chain.push_back(current);
+        const auto nh = slot.nearest_higher[current];
+        if (nh == -1)
+          break;
+        if (!slot.owned[nh]) {
+          label = pending;
+          exit = indexes[nh];
+          break;
+        }
+        current = static_cast<std::size_t>(nh);
+      }
+      for (auto point : chain) {
+        local[point] = label;
+        exits[point] = exit;
+      }
+
+      labels[indexes[k]] = (local[k] == pending) ? -1 : local[k];
+      if (local[k] == pending)
+        m_pending.emplace_back(indexes[k], exits[k]);
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void OutOfCoreClusterer<Ndim, TData>::stitch(std::span<int32_t> labels) const {
+    const std::unordered_map<int64_t, int64_t> exits(m_pending.begin(), m_pending.end());
+    for (const auto& [point, exit] : m_pending) {
+      auto target = exit;
+      std::size_t steps = 0;
+      for (auto it = exits.find(target); it != exits.end(); it = exits.find(target)) {
+        target = it->second;
+        if (++steps > exits.size()) {
+          throw std::runtime_error("The nearest-higher links of the chunks form a cycle");
+        }
+      }
+      labels[point] = labels[target];
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  template <concepts::convolutional_kernel Kernel, concepts::distance_metric<Ndim> DistanceMetric>
+  inline std::size_t OutOfCoreClusterer<Ndim, TData>::make_clusters(const std::string& input_path,
+                                                                    const std::string& output_path,
+                                                                    const DistanceMetric& metric,
+                                                                    const Kernel& kernel) {
+    const auto input = internal::MappedFile::open(input_path);
+    if (input.size() % ((Ndim + 1) * sizeof(value_type)) != 0) {
+      throw std::invalid_argument("The size of the input file " + input_path +
+                                  " is not a multiple of the size of a point");
+    }
+    const auto points = input.template as<const value_type>();
+    const auto n_points = points.size() / (Ndim + 1);
+    const auto output = internal::MappedFile::create(output_path, n_points * sizeof(int32_t));
+    const auto labels = output.template as<int32_t>();
+
+    m_chunks.clear();
+    m_pending.clear();
+    m_n_clusters = 0;
+    if (n_points == 0)
+      return 0;
+
+    const auto binning = make_binning(points, n_points);
+    make_chunks(points, n_points, binning);
+    const auto n_indexes = m_chunks.back().offset + m_chunks.back().size;
+    const auto index_file =
+        internal::MappedFile::scratch(output_path + ".chunks", n_indexes * sizeof(int64_t));
+    const auto indexes = index_file.template as<int64_t>();
+    fill_indexes(points, n_points, binning, indexes);
+
+    auto chunk_indexes = [&](const Slot& slot) {
+      const auto& chunk = m_chunks[slot.chunk];
+      return std::span<const int64_t>(indexes.subspan(chunk.offset, chunk.size));
+    };
+
+    // the chunks are clustered concurrently on the slots, but their results are assigned in
+    // order, so that the clusters are numbered chunk by chunk and the numbering doesn't depend on
+    // the number of slots
+    std::size_t n_processed = 0;
+    try {
+      for (auto c = 0u; c < m_chunks.size(); ++c) {
+        if (m_chunks[c].owned == 0)
+          continue;
+        auto& slot = *m_slots[n_processed++ % m_slots.size()];
+        if (slot.result.valid()) {
+          slot.result.get();
+          assign_chunk(slot, chunk_indexes(slot), labels);
+        }
+        slot.chunk = c;
+        slot.result = std::async(std::launch::async, [&, &slot = slot] {
+          cluster_chunk(slot, points, chunk_indexes(slot), binning, metric, kernel);
+        });
+      }
+      const auto first = n_processed - std::min(n_processed, m_slots.size());
+      for (auto i = first; i < n_processed; ++i) {
+        auto& slot = *m_slots[i % m_slots.size()];
+        slot.result.get();
+        assign_chunk(slot, chunk_indexes(slot), labels);
+      }
+    } catch (...) {
+      for (auto& slot : m_slots) {
+        if (slot->result.valid())
+          slot->result.wait();
+        slot->result = {};
+      }
+      throw;
+    }
+
+    stitch(labels);
+    return static_cast<std::size_t>(m_n_clusters);
+  }
+
+}  // namespace clue
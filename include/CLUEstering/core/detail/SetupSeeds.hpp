@@ -18,7 +18,6 @@ namespace clue::detail {
     } else {
       seeds->reset(queue);
     }
-    alpaka::wait(queue);
   }
 
 }  // namespace clue::detail
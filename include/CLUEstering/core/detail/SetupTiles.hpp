@@ -8,6 +8,7 @@
 #include "CLUEstering/detail/concepts.hpp"
 #include "CLUEstering/internal/nostd/ceil_div.hpp"
 #include "CLUEstering/internal/nostd/pow.hpp"
+#include <algorithm>
 #include <array>
 #include <concepts>
 #include <cstddef>
@@ -16,46 +17,110 @@
 
 namespace clue::detail {
 
-  template <concepts::queue TQueue,
-            std::size_t Ndim,
-            std::floating_point TInput,
-            concepts::device TDev = decltype(alpaka::getDev(std::declval<TQueue>()))>
-  void setup_tiles(TQueue& queue,
-                   const PointsHost<Ndim, TInput>& points,
-                   std::optional<internal::Tiles<Ndim, std::remove_cv_t<TInput>, TDev>>& tiles,
-                   int points_per_tile,
-                   const std::array<uint8_t, Ndim>& wrapped_coordinates,
-                   std::size_t batch_size = 1) {
+  // Number of tiles along each dimension of a grid holding points_per_tile points per tile on
+  // average
+  template <std::size_t Ndim>
+  int32_t tiles_per_dim(int32_t n_points, int points_per_tile) {
     // TODO: reconsider the way that we compute the number of tiles
-    auto ntiles = nostd::ceil_div(points.size(), points_per_tile);
+    auto ntiles = nostd::ceil_div(n_points, points_per_tile);
     int32_t n_per_dim = 1;
     while (nostd::pow(n_per_dim, Ndim) < ntiles)
       ++n_per_dim;
-    ntiles = nostd::pow(n_per_dim, Ndim);
+    return n_per_dim;
+  }
+
+  // Allocates the tiles for a grid with n_per_dim tiles per dimension, or resets them when they
+  // are already large enough
+  template <concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TInput,
+            concepts::device TDev,
+            typename TPoints>
+  void reserve_tiles(TQueue& queue,
+                     const TPoints& points,
+                     std::optional<internal::Tiles<Ndim, TInput, TDev>>& tiles,
+                     int32_t n_per_dim,
+                     std::size_t batch_size) {
+    const auto ntiles = nostd::pow(n_per_dim, Ndim);
 
     if (!tiles.has_value()) {
-      tiles = std::make_optional<internal::Tiles<Ndim, std::remove_cv_t<TInput>, TDev>>(
+      tiles = std::make_optional<internal::Tiles<Ndim, TInput, TDev>>(
           queue, points.size(), ntiles, batch_size);
     }
     // check if tiles are large enough for current data
     if ((tiles->extents().values < static_cast<std::size_t>(points.size())) or
-        (tiles->extents().keys < static_cast<std::size_t>(ntiles))) {
+        (tiles->extents().keys < static_cast<std::size_t>(ntiles) * batch_size) or
+        (tiles->batchCapacity() < batch_size)) {
       tiles->initialize(queue, points.size(), ntiles, n_per_dim, batch_size);
     } else {
       tiles->reset(points.size(), ntiles, n_per_dim, batch_size);
     }
+  }
 
-    auto min_max =
-        clue::make_host_buffer<internal::CoordinateExtremes<Ndim, std::remove_cv_t<TInput>>>(queue);
-    auto tile_sizes = clue::make_host_buffer<std::remove_cv_t<TInput>[Ndim]>(queue);
-    detail::compute_tile_size(min_max.data(), tile_sizes.data(), points, n_per_dim);
+  template <concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TInput,
+            concepts::device TDev,
+            typename TPoints>
+  void setup_tiles_grid(TQueue& queue,
+                        const TPoints& points,
+                        std::optional<internal::Tiles<Ndim, TInput, TDev>>& tiles,
+                        int32_t n_per_dim,
+                        const internal::CoordinateExtremes<Ndim, TInput>& min_max,
+                        const std::array<uint8_t, Ndim>& wrapped_coordinates,
+                        std::size_t batch_size) {
+    reserve_tiles(queue, points, tiles, n_per_dim, batch_size);
+
+    // every event starts from the extremes of the whole batch, which the batched clustering
+    // then narrows down to the extremes of each event
+    auto h_min_max =
+        clue::make_host_buffer<internal::CoordinateExtremes<Ndim, TInput>[]>(queue, batch_size);
+    auto tile_sizes = clue::make_host_buffer<TInput[]>(queue, Ndim * batch_size);
+    for (auto event = 0u; event != batch_size; ++event) {
+      h_min_max[event] = min_max;
+      for (auto dim = 0u; dim != Ndim; ++dim) {
+        tile_sizes[event * Ndim + dim] = min_max.range(dim) / n_per_dim;
+      }
+    }
 
-    alpaka::memcpy(queue, tiles->minMax(), min_max);
-    alpaka::memcpy(queue, tiles->tileSize(), tile_sizes);
+    const auto device = alpaka::getDev(queue);
+    alpaka::memcpy(
+        queue, clue::make_device_view(device, tiles->minMax().data(), batch_size), h_min_max);
+    alpaka::memcpy(queue,
+                   clue::make_device_view(device, tiles->tileSize().data(), Ndim * batch_size),
+                   tile_sizes);
     alpaka::memcpy(queue, tiles->wrapped(), clue::make_host_view(wrapped_coordinates.data(), Ndim));
     alpaka::wait(queue);
   }
 
+  template <std::size_t Ndim, std::floating_point TInput, typename TPoints>
+  internal::CoordinateExtremes<Ndim, std::remove_cv_t<TInput>> compute_extremes(
+      const TPoints& points) {
+    internal::CoordinateExtremes<Ndim, std::remove_cv_t<TInput>> min_max;
+    std::remove_cv_t<TInput> tile_sizes[Ndim];
+    detail::compute_tile_size(&min_max, tile_sizes, points, 1);
+    return min_max;
+  }
+
+  template <concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TInput,
+            concepts::device TDev = decltype(alpaka::getDev(std::declval<TQueue>()))>
+  void setup_tiles(TQueue& queue,
+                   const PointsHost<Ndim, TInput>& points,
+                   std::optional<internal::Tiles<Ndim, std::remove_cv_t<TInput>, TDev>>& tiles,
+                   int points_per_tile,
+                   const std::array<uint8_t, Ndim>& wrapped_coordinates,
+                   std::size_t batch_size = 1) {
+    setup_tiles_grid(queue,
+                     points,
+                     tiles,
+                     tiles_per_dim<Ndim>(points.size(), points_per_tile),
+                     compute_extremes<Ndim, TInput>(points),
+                     wrapped_coordinates,
+                     batch_size);
+  }
+
   template <concepts::queue TQueue,
             std::size_t Ndim,
             std::floating_point TInput,
@@ -66,33 +131,81 @@ namespace clue::detail {
                    int points_per_tile,
                    const std::array<uint8_t, Ndim>& wrapped_coordinates,
                    std::size_t batch_size = 1) {
-    auto ntiles = nostd::ceil_div(points.size(), points_per_tile);
-    int32_t n_per_dim = 1;
-    while (nostd::pow(n_per_dim, Ndim) < ntiles)
-      ++n_per_dim;
-    ntiles = nostd::pow(n_per_dim, Ndim);
+    setup_tiles_grid(queue,
+                     points,
+                     tiles,
+                     tiles_per_dim<Ndim>(points.size(), points_per_tile),
+                     compute_extremes<Ndim, TInput>(points),
+                     wrapped_coordinates,
+                     batch_size);
+  }
 
-    if (!tiles.has_value()) {
-      tiles = std::make_optional<internal::Tiles<Ndim, std::remove_cv_t<TInput>, TDev>>(
-          queue, points.size(), ntiles, batch_size);
-    }
-    // check if tiles are large enough for current data
-    if ((tiles->extents().values < static_cast<std::size_t>(points.size())) or
-        (tiles->extents().keys < static_cast<std::size_t>(ntiles))) {
-      tiles->initialize(queue, points.size(), ntiles, n_per_dim, batch_size);
-    } else {
-      tiles->reset(points.size(), ntiles, n_per_dim, batch_size);
+  // Sets up a grid whose tiles are not smaller than the search radius along any coordinate,
+  // but not finer than a reference grid with max_n_per_dim tiles per dimension
+  template <concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TInput,
+            concepts::device TDev,
+            typename TPoints>
+  void setup_tiles_for_radius(TQueue& queue,
+                              const TPoints& points,
+                              std::optional<internal::Tiles<Ndim, TInput, TDev>>& tiles,
+                              TInput radius,
+                              int32_t max_n_per_dim,
+                              const std::array<uint8_t, Ndim>& wrapped_coordinates,
+                              std::size_t batch_size = 1) {
+    const auto min_max = compute_extremes<Ndim, TInput>(points);
+    auto n_per_dim = max_n_per_dim;
+    for (auto dim = 0u; dim != Ndim; ++dim) {
+      n_per_dim = std::min(n_per_dim, static_cast<int32_t>(min_max.range(dim) / radius));
     }
+    n_per_dim = std::max(n_per_dim, 1);
 
-    auto min_max =
-        clue::make_host_buffer<internal::CoordinateExtremes<Ndim, std::remove_cv_t<TInput>>>(queue);
-    auto tile_sizes = clue::make_host_buffer<std::remove_cv_t<TInput>[Ndim]>(queue);
-    detail::compute_tile_size(min_max.data(), tile_sizes.data(), points, n_per_dim);
+    setup_tiles_grid(
+        queue, points, tiles, n_per_dim, min_max, wrapped_coordinates, batch_size);
+  }
 
-    alpaka::memcpy(queue, tiles->minMax(), min_max);
-    alpaka::memcpy(queue, tiles->tileSize(), tile_sizes);
-    alpaka::memcpy(queue, tiles->wrapped(), clue::make_host_view(wrapped_coordinates.data(), Ndim));
+  // Checks whether points with the given extremes can be binned in the grid of the tiles. The
+  // grid is not reused when the points shrank to less than half of its range along a coordinate,
+  // as most of its tiles would then be empty.
+  template <concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TInput,
+            concepts::device TDev>
+  bool fits_tiles_grid(TQueue& queue,
+                       const internal::Tiles<Ndim, TInput, TDev>& tiles,
+                       const internal::CoordinateExtremes<Ndim, TInput>& min_max) {
+    auto grid = clue::make_host_buffer<internal::CoordinateExtremes<Ndim, TInput>[]>(queue, 1);
+    alpaka::memcpy(
+        queue, grid, clue::make_device_view(alpaka::getDev(queue), tiles.minMax().data(), 1));
     alpaka::wait(queue);
+    for (auto dim = 0u; dim != Ndim; ++dim) {
+      if (min_max.min(dim) < grid[0].min(dim) || min_max.max(dim) > grid[0].max(dim) ||
+          2 * min_max.range(dim) < grid[0].range(dim))
+        return false;
+    }
+    return true;
+  }
+
+  // Sets up the tiles of a batch of device points without synchronizing the queue. The extremes
+  // of the whole batch are reduced on the device instead of being read back, so the grid has
+  // n_per_dim tiles per dimension whatever the extent of the points. The wrapped coordinates must
+  // outlive the copy enqueued here.
+  template <concepts::accelerator TAcc,
+            concepts::queue TQueue,
+            std::size_t Ndim,
+            std::floating_point TInput,
+            concepts::device TDev>
+  void setup_batch_tiles(
+      TQueue& queue,
+      PointsDevice<Ndim, TInput, TDev>& points,
+      std::optional<internal::Tiles<Ndim, std::remove_cv_t<TInput>, TDev>>& tiles,
+      int32_t n_per_dim,
+      const std::array<uint8_t, Ndim>& wrapped_coordinates,
+      std::size_t batch_size) {
+    reserve_tiles(queue, points, tiles, n_per_dim, batch_size);
+    alpaka::memcpy(queue, tiles->wrapped(), clue::make_host_view(wrapped_coordinates.data(), Ndim));
+    computeBatchExtremes<TAcc>(queue, 256, tiles->view(), points.view(), batch_size);
   }
 
 }  // namespace clue::detail
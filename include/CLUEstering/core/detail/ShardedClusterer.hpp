@@ -0,0 +1,220 @@
+
+#pragma once
+
+#include "CLUEstering/core/ShardedClusterer.hpp"
+#include "CLUEstering/data_structures/PointsDevice.hpp"
+#include "CLUEstering/data_structures/PointsHost.hpp"
+#include "CLUEstering/internal/alpaka/devices.hpp"
+#include "CLUEstering/internal/alpaka/memory.hpp"
+
+#include <alpaka/alpaka.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace clue {
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline ShardedClusterer<Ndim, TData>::ShardedClusterer(
+      std::span<const Device> devices,
+      std::size_t n_shards,
+      value_type density_radius,
+      value_type min_density,
+      std::optional<value_type> outlier_distance,
+      std::optional<value_type> seeding_distance)
+      : m_shards{},
+        m_halo_width{density_radius + std::max(outlier_distance.value_or(density_radius),
+                                               seeding_distance.value_or(density_radius))} {
+    if (devices.empty() || n_shards == 0) {
+      throw std::invalid_argument("The clusterer must have at least one device and one shard");
+    }
+    m_shards.reserve(n_shards);
+    for (auto i = 0u; i < n_shards; ++i) {
+      m_shards.push_back(std::make_unique<Shard>(devices[i % devices.size()],
+                                                 density_radius,
+                                                 min_density,
+                                                 outlier_distance,
+                                                 seeding_distance));
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline ShardedClusterer<Ndim, TData>::ShardedClusterer(
+      std::size_t n_shards,
+      value_type density_radius,
+      value_type min_density,
+      std::optional<value_type> outlier_distance,
+      std::optional<value_type> seeding_distance)
+      : ShardedClusterer(devices<Platform>(),
+                         n_shards,
+                         density_radius,
+                         min_density,
+                         outlier_distance,
+                         seeding_distance) {}
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void ShardedClusterer<Ndim, TData>::partition(std::span<const value_type> coordinates) {
+    std::vector<value_type> sorted(coordinates.begin(), coordinates.end());
+    std::ranges::sort(sorted);
+
+    const auto n_shards = m_shards.size();
+    for (auto i = 0u; i < n_shards; ++i) {
+      auto& shard = *m_shards[i];
+      shard.begin = (i == 0) ? -std::numeric_limits<value_type>::infinity()
+                             : sorted[i * sorted.size() / n_shards];
+      shard.end = (i == n_shards - 1) ? std::numeric_limits<value_type>::infinity()
+                                      : sorted[(i + 1) * sorted.size() / n_shards];
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  template <concepts::convolutional_kernel Kernel, concepts::distance_metric<Ndim> DistanceMetric>
+  inline void ShardedClusterer<Ndim, TData>::cluster_shard(
+      Shard& shard,
+      const PointsHost<Ndim, value_type>& points,
+      std::size_t axis,
+      const DistanceMetric& metric,
+      const Kernel& kernel) {
+    const auto coordinates = points.coords(axis);
+    shard.indexes.clear();
+    auto n_owned = 0u;
+    for (auto i = 0; i < points.size(); ++i) {
+      if (coordinates[i] >= shard.begin - m_halo_width && coordinates[i] < shard.end + m_halo_width)
+        shard.indexes.push_back(i);
+      if (coordinates[i] >= shard.begin && coordinates[i] < shard.end)
+        ++n_owned;
+    }
+    // a slab owning no points only contains points clustered by its neighbours
+    if (n_owned == 0) {
+      shard.indexes.clear();
+      return;
+    }
+
+    const auto size = static_cast<int32_t>(shard.indexes.size());
+    PointsHost<Ndim, value_type> h_points(shard.queue, size);
+    for (auto dim = 0u; dim < Ndim; ++dim) {
+      std::ranges::transform(shard.indexes, h_points.coords(dim).begin(), [&](auto i) {
+        return points.coords(dim)[i];
+      });
+    }
+    std::ranges::transform(
+        shard.indexes, h_points.weights().begin(), [&](auto i) { return points.weights()[i]; });
+    // the points are tagged with their global identifiers, so that the ties in density are broken
+    // as if the whole dataset was clustered at once
+    shard.tags.resize(shard.indexes.size());
+    std::ranges::transform(shard.indexes, shard.tags.begin(), [&](auto i) {
+      return points.view().has_tags() ? points.view().m_tags[i] : static_cast<uint32_t>(i);
+    });
+    h_points.set_tags(shard.tags);
+
+    PointsDevice<Ndim, value_type> d_points(shard.queue, size);
+    shard.clusterer.make_clusters(shard.queue, h_points, d_points, metric, kernel);
+
+    shard.nearest_higher.resize(shard.indexes.size());
+    shard.is_seed.resize(shard.indexes.size());
+    const auto device = alpaka::getDev(shard.queue);
+    alpaka::memcpy(shard.queue,
+                   make_host_view(shard.nearest_higher.data(), size),
+                   make_device_view(device, d_points.view().m_nearest_higher, size));
+    alpaka::memcpy(shard.queue,
+                   make_host_view(shard.is_seed.data(), size),
+                   make_device_view(device, d_points.view().m_is_seed, size));
+    alpaka::wait(shard.queue);
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  inline void ShardedClusterer<Ndim, TData>::stitch(PointsHost<Ndim, value_type>& points,
+                                                    std::size_t axis) const {
+    const auto n_points = static_cast<std::size_t>(points.size());
+    const auto coordinates = points.coords(axis);
+
+    // the links of each point are taken from the slab that owns it, and may point to the halo
+    std::vector<int32_t> nearest_higher(n_points, -1);
+    std::vector<bool> is_seed(n_points, false);
+    for (const auto& shard : m_shards) {
+      for (auto k = 0u; k < shard->indexes.size(); ++k) {
+        const auto i = shard->indexes[k];
+        if (coordinates[i] < shard->begin || coordinates[i] >= shard->end)
+          continue;
+        const auto nh = shard->nearest_higher[k];
+        nearest_higher[i] = (nh == -1) ? -1 : shard->indexes[nh];
+        is_seed[i] = shard->is_seed[k] != 0;
+      }
+    }
+
+    constexpr int32_t unresolved = -2;
+    auto cluster_indexes = std::span<int32_t>(points.view().m_cluster_index, n_points);
+    std::ranges::fill(cluster_indexes, unresolved);
+    int32_t n_clusters = 0;
+    for (auto i = 0u; i < n_points; ++i) {
+      if (is_seed[i])
+        cluster_indexes[i] = n_clusters++;
+    }
+
+    // the follower chains are resolved once, labelling all the points met along the way
+    std::vector<int32_t> chain;
+    for (auto i = 0u; i < n_points; ++i) {
+      chain.clear();
+      auto current = static_cast<int32_t>(i);
+      while (cluster_indexes[current] == unresolved) {
+        chain.push_back(current);
+        if (nearest_higher[current] == -1)
+          break;
+        current = nearest_higher[current];
+        if (chain.size() > n_points) {
+          throw std::runtime_error("The nearest-higher links of the shards form a cycle");
+        }
+      }
+      const auto cluster = (cluster_indexes[current] == unresolved) ? -1 : cluster_indexes[current];
+      for (auto point : chain)
+        cluster_indexes[point] = cluster;
+    }
+  }
+
+  template <std::size_t Ndim, std::floating_point TData>
+  template <concepts::convolutional_kernel Kernel, concepts::distance_metric<Ndim> DistanceMetric>
+  inline void ShardedClusterer<Ndim, TData>::make_clusters(PointsHost<Ndim, value_type>& points,
+                                                           const DistanceMetric& metric,
+                                                           const Kernel& kernel) {
+    if (points.size() == 0) {
+      internal::points_interface<PointsHost<Ndim, value_type>>::mark_clustered(points);
+      return;
+    }
+
+    // the slabs are cut along the axis where the points are most spread
+    auto axis = 0u;
+    auto longest = value_type{-1};
+    for (auto dim = 0u; dim < Ndim; ++dim) {
+      const auto [min, max] = std::ranges::minmax(points.coords(dim));
+      if (max - min > longest) {
+        axis = dim;
+        longest = max - min;
+      }
+    }
+    partition(points.coords(axis));
+
+    std::vector<std::future<void>> results;
+    results.reserve(m_shards.size());
+    for (auto& shard : m_shards) {
+      results.push_back(std::async(std::launch::async, [&, &shard = *shard] {
+        cluster_shard(shard, points, axis, metric, kernel);
+      }));
+    }
+    // all the shards are waited for before rethrowing the first exception
+    for (auto& result : results)
+      result.wait();
+    for (auto& result : results)
+      result.get();
+
+    stitch(points, axis);
+    internal::points_interface<PointsHost<Ndim, value_type>>::mark_clustered(points);
+  }
+
+}  // namespace clue
@@ -0,0 +1,45 @@
+
+#pragma once
+
+namespace clue::detail {
+
+  // Online estimate of the time needed to cluster an event as a linear function of its size,
+  // with the older measurements exponentially discounted
+  class ThroughputModel {
+    double m_decay;
+    double m_weight = 0.;
+    double m_sum_x = 0.;
+    double m_sum_y = 0.;
+    double m_sum_xx = 0.;
+    double m_sum_xy = 0.;
+
+  public:
+    explicit ThroughputModel(double decay = 0.95) : m_decay{decay} {}
+
+    void update(double n_points, double seconds) {
+      m_weight = m_decay * m_weight + 1.;
+      m_sum_x = m_decay * m_sum_x + n_points;
+      m_sum_y = m_decay * m_sum_y + seconds;
+      m_sum_xx = m_decay * m_sum_xx + n_points * n_points;
+      m_sum_xy = m_decay * m_sum_xy + n_points * seconds;
+    }
+
+    bool ready() const { return m_weight > 0.; }
+
+    double predict(double n_points) const {
+      const auto mean_x = m_sum_x / m_weight;
+      const auto mean_y = m_sum_y / m_weight;
+      const auto variance = m_sum_xx / m_weight - mean_x * mean_x;
+      // with events of similar sizes the intercept can't be estimated, so the time is taken as
+      // proportional to the size
+      if (variance > 1e-3 * mean_x * mean_x) {
+        const auto slope = (m_sum_xy / m_weight - mean_x * mean_y) / variance;
+        const auto intercept = mean_y - slope * mean_x;
+        if (slope > 0. && intercept >= 0.)
+          return intercept + slope * n_points;
+      }
+      return (mean_x > 0.) ? mean_y * n_points / mean_x : mean_y;
+    }
+  };
+
+}  // namespace clue::detail
@@ -207,8 +207,11 @@ namespace clue {
     ALPAKA_FN_HOST void fill_batch(TQueue& queue,
                                    size_type size,
                                    TFunc func,
-                                   const auto& event_offsets,
-                                   std::size_t max_event_size);
+                                   const auto& event_offsets);
+    // Moves to their new key the elements whose key changed since the map was filled, leaving
+    // the others in their bins, and returns the number of elements moved
+    template <concepts::accelerator TAcc, typename TFunc, concepts::queue TQueue>
+    ALPAKA_FN_HOST size_type update(size_type size, TFunc func, TQueue& queue);
 
     ALPAKA_FN_HOST const auto& indexes() const;
     ALPAKA_FN_HOST auto& indexes();
@@ -0,0 +1,50 @@
+/// @file EventBatch.hpp
+/// @brief Defines the descriptors of the events of a batch and of their clustering parameters
+/// @authors Simone Balducci, Felice Pantaleo, Marco Rovere, Wahid Redjeb, Aurora Perego, Francesco Giacomini
+
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <span>
+
+namespace clue {
+
+  /// @brief Sizes of the events of a batch, stored in device memory
+  ///
+  /// @note The sizes are read only on the device, so they can be produced by a kernel without
+  /// being copied back to the host
+  struct DeviceEventSizes {
+    std::span<const uint32_t> sizes;
+  };
+
+  /// @brief Offsets of the events of a batch, stored in device memory
+  ///
+  /// @note The offsets must contain one element more than the number of events, starting from 0
+  /// and ending with the total number of points
+  struct DeviceEventOffsets {
+    std::span<const uint32_t> offsets;
+  };
+
+  /// @brief Clustering parameters of a single event of a batch
+  ///
+  /// @tparam TData The data type of the parameters, which must be a floating-point type
+  /// @note Unlike in Clusterer::setParameters, the outlier and seeding distances have no default
+  /// and must always be set
+  template <std::floating_point TData>
+  struct EventParameters {
+    TData density_radius;
+    TData min_density;
+    TData outlier_distance;
+    TData seeding_distance;
+  };
+
+  /// @brief Clustering parameters of each event of a batch, stored in device memory
+  ///
+  /// @tparam TData The data type of the parameters, which must be a floating-point type
+  template <std::floating_point TData>
+  struct DeviceEventParameters {
+    std::span<const EventParameters<TData>> parameters;
+  };
+
+}  // namespace clue
@@ -3,7 +3,9 @@
 
 #include "CLUEstering/data_structures/AssociationMap.hpp"
 #include "CLUEstering/data_structures/AssociationMapView.hpp"
+#include "CLUEstering/data_structures/internal/FindEvent.hpp"
 #include "CLUEstering/detail/concepts.hpp"
+#include "CLUEstering/internal/alpaka/exec.hpp"
 #include "CLUEstering/internal/alpaka/memory.hpp"
 #include "CLUEstering/internal/alpaka/work_division.hpp"
 #include "CLUEstering/internal/algorithm/scan/scan.hpp"
@@ -30,19 +32,16 @@ namespace clue {
         }
       }
       template <typename TAcc>
-        requires(alpaka::Dim<TAcc>::value == 2)
+        requires(alpaka::Dim<TAcc>::value == 1)
       ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    size_t size,
                                     int32_t* associations,
                                     TFunc func,
                                     const auto* event_offsets,
-                                    std::size_t max_event_size,
-                                    std::size_t /* blocks_per_event */) const {
-        for (auto event : alpaka::uniformElementsAlong<0u>(acc)) {
-          for (auto local_idx : alpaka::uniformElementsAlong<1u>(acc, max_event_size)) {
-            auto global_idx = event_offsets[event] + local_idx;
-            if (global_idx < event_offsets[event + 1])
-              associations[global_idx] = func(global_idx, event);
-          }
+                                    std::size_t batch_size) const {
+        for (auto i : alpaka::uniformElements(acc, size)) {
+          const auto event = find_event(event_offsets, batch_size, i);
+          associations[i] = event < batch_size ? func(i, event) : -1;
         }
       }
     };
@@ -80,6 +79,124 @@ namespace clue {
       }
     };
 
+    struct KernelRecordAssociations {
+      template <typename TAcc>
+      ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    const int32_t* indexes,
+                                    const int32_t* offsets,
+                                    int32_t* associations,
+                                    std::size_t nkeys) const {
+        for (auto key : alpaka::uniformElements(acc, nkeys)) {
+          for (auto i = offsets[key]; i < offsets[key + 1]; ++i)
+            associations[indexes[i]] = static_cast<int32_t>(key);
+        }
+      }
+    };
+
+    template <typename TFunc>
+    struct KernelFlagMovedElements {
+      template <typename TAcc>
+      ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    const int32_t* associations,
+                                    int32_t* new_associations,
+                                    int32_t* moved,
+                                    TFunc func,
+                                    std::size_t size) const {
+        for (auto i : alpaka::uniformElements(acc, size)) {
+          new_associations[i] = func(i);
+          moved[i] = (new_associations[i] != associations[i]);
+        }
+      }
+    };
+
+    // Lists the moved elements, given the inclusive scan of their flags
+    struct KernelCompactMovedElements {
+      template <typename TAcc>
+      ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    const int32_t* moved_positions,
+                                    int32_t* moved_elements,
+                                    std::size_t size) const {
+        for (auto i : alpaka::uniformElements(acc, size)) {
+          const auto previous = (i > 0) ? moved_positions[i - 1] : 0;
+          if (moved_positions[i] > previous)
+            moved_elements[previous] = static_cast<int32_t>(i);
+        }
+      }
+    };
+
+    struct KernelCountMovedElements {
+      template <typename TAcc>
+      ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    const int32_t* moved_elements,
+                                    const int32_t* associations,
+                                    const int32_t* new_associations,
+                                    int32_t* bin_sizes,
+                                    std::size_t n_moved) const {
+        for (auto k : alpaka::uniformElements(acc, n_moved)) {
+          const auto i = moved_elements[k];
+          if (associations[i] >= 0)
+            alpaka::atomicSub(acc, &bin_sizes[associations[i]], 1);
+          if (new_associations[i] >= 0)
+            alpaka::atomicAdd(acc, &bin_sizes[new_associations[i]], 1);
+        }
+      }
+    };
+
+    struct KernelComputeBinSizes {
+      template <typename TAcc>
+      ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    const int32_t* offsets,
+                                    int32_t* bin_sizes,
+                                    std::size_t nkeys) const {
+        for (auto key : alpaka::uniformElements(acc, nkeys)) {
+          bin_sizes[key] = offsets[key + 1] - offsets[key];
+        }
+      }
+    };
+
+    // Copies the elements that stayed in each bin to the start of its new range, and sets the
+    // position from which the elements moved into the bin are appended
+    struct KernelKeepUnmovedElements {
+      template <typename TAcc>
+      ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    const int32_t* indexes,
+                                    const int32_t* offsets,
+                                    const int32_t* new_offsets,
+                                    const int32_t* associations,
+                                    const int32_t* new_associations,
+                                    int32_t* new_indexes,
+                                    int32_t* cursors,
+                                    std::size_t nkeys) const {
+        for (auto key : alpaka::uniformElements(acc, nkeys)) {
+          auto cursor = new_offsets[key];
+          for (auto i = offsets[key]; i < offsets[key + 1]; ++i) {
+            const auto element = indexes[i];
+            if (new_associations[element] == associations[element])
+              new_indexes[cursor++] = element;
+          }
+          cursors[key] = cursor;
+        }
+      }
+    };
+
+    struct KernelAppendMovedElements {
+      template <typename TAcc>
+      ALPAKA_FN_ACC void operator()(const TAcc& acc,
+                                    const int32_t* moved_elements,
+                                    const int32_t* new_associations,
+                                    int32_t* new_indexes,
+                                    int32_t* cursors,
+                                    std::size_t n_moved) const {
+        for (auto k : alpaka::uniformElements(acc, n_moved)) {
+          const auto i = moved_elements[k];
+          if (new_associations[i] >= 0) {
+            const auto position = alpaka::atomicAdd(acc, &cursors[new_associations[i]], 1);
+            new_indexes[position] = i;
+          }
+        }
+      }
+    };
+
   }  // namespace detail
 
   template <concepts::device TDev>
@@ -325,17 +442,17 @@ namespace clue {
     const auto blocksize = 512;
     const auto gridsize = divide_up_by(size, blocksize);
     const auto workdiv = make_workdiv<TAcc>(gridsize, blocksize);
-    alpaka::exec<TAcc>(
+    internal::exec<TAcc>(
         queue, workdiv, detail::KernelComputeAssociations<TFunc>{}, size, bin_buffer.data(), func);
 
     auto sizes_buffer = make_device_buffer<int32_t[]>(queue, m_extents.keys);
     alpaka::memset(queue, sizes_buffer, 0);
-    alpaka::exec<TAcc>(queue,
-                       workdiv,
-                       detail::KernelComputeAssociationSizes{},
-                       bin_buffer.data(),
-                       sizes_buffer.data(),
-                       size);
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelComputeAssociationSizes{},
+                         bin_buffer.data(),
+                         sizes_buffer.data(),
+                         size);
 
     auto temp_offsets = make_device_buffer<int32_t[]>(queue, m_extents.keys + 1);
     alpaka::memset(queue, temp_offsets, 0u, 1u);
@@ -344,14 +461,14 @@ namespace clue {
     alpaka::memcpy(queue,
                    make_device_view(alpaka::getDev(queue), m_offsets.data(), m_extents.keys + 1),
                    temp_offsets);
-    alpaka::exec<TAcc>(queue,
-                       workdiv,
-                       detail::KernelFillAssociator{},
-                       m_indexes.data(),
-                       bin_buffer.data(),
-                       temp_offsets.data(),
-                       m_extents.keys,
-                       size);
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelFillAssociator{},
+                         m_indexes.data(),
+                         bin_buffer.data(),
+                         temp_offsets.data(),
+                         m_extents.keys,
+                         size);
     alpaka::wait(queue);
   }
 
@@ -395,12 +512,12 @@ namespace clue {
 
     auto sizes_buffer = make_device_buffer<key_type[]>(queue, m_extents.keys);
     alpaka::memset(queue, sizes_buffer, 0);
-    alpaka::exec<TAcc>(queue,
-                       workdiv,
-                       detail::KernelComputeAssociationSizes{},
-                       associations.data(),
-                       sizes_buffer.data(),
-                       associations.size());
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelComputeAssociationSizes{},
+                         associations.data(),
+                         sizes_buffer.data(),
+                         associations.size());
 
     auto temp_offsets = make_device_buffer<key_type[]>(queue, m_extents.keys + 1);
     alpaka::memset(queue, temp_offsets, 0u, 1u);
@@ -411,14 +528,14 @@ namespace clue {
     alpaka::memcpy(queue,
                    make_device_view(alpaka::getDev(queue), m_offsets.data(), m_extents.keys + 1),
                    temp_offsets);
-    alpaka::exec<TAcc>(queue,
-                       workdiv,
-                       detail::KernelFillAssociator{},
-                       m_indexes.data(),
-                       associations.data(),
-                       temp_offsets.data(),
-                       m_extents.keys,
-                       associations.size());
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelFillAssociator{},
+                         m_indexes.data(),
+                         associations.data(),
+                         temp_offsets.data(),
+                         m_extents.keys,
+                         associations.size());
     alpaka::wait(queue);
   }
 
@@ -427,36 +544,32 @@ namespace clue {
   ALPAKA_FN_HOST inline void AssociationMap<TDev>::fill_batch(TQueue& queue,
                                                               size_type size,
                                                               TFunc func,
-                                                              const auto& event_offsets,
-                                                              std::size_t max_event_size) {
+                                                              const auto& event_offsets) {
     if (m_extents.keys == 0 || m_extents.values == 0)
       return;
 
     auto bin_buffer = make_device_buffer<int32_t[]>(queue, size);
 
     const auto blocksize = 256;
-    const auto blocks_per_event = divide_up_by(max_event_size, blocksize);
     const auto batch_size = alpaka::getExtents(event_offsets)[0] - 1;
-    const auto batch_workdiv =
-        make_workdiv<internal::Acc2D>({batch_size, blocks_per_event}, {1, blocksize});
-    alpaka::exec<internal::Acc2D>(queue,
-                                  batch_workdiv,
-                                  detail::KernelComputeAssociations<TFunc>{},
-                                  bin_buffer.data(),
-                                  func,
-                                  event_offsets.data(),
-                                  max_event_size,
-                                  blocks_per_event);
+    const auto workdiv = make_workdiv<TAcc>(divide_up_by(size, blocksize), blocksize);
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelComputeAssociations<TFunc>{},
+                         size,
+                         bin_buffer.data(),
+                         func,
+                         event_offsets.data(),
+                         batch_size);
 
     auto sizes_buffer = make_device_buffer<int32_t[]>(queue, m_extents.keys);
-    const auto workdiv = make_workdiv<TAcc>(size, blocksize);
     alpaka::memset(queue, sizes_buffer, 0);
-    alpaka::exec<TAcc>(queue,
-                       workdiv,
-                       detail::KernelComputeAssociationSizes{},
-                       bin_buffer.data(),
-                       sizes_buffer.data(),
-                       size);
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelComputeAssociationSizes{},
+                         bin_buffer.data(),
+                         sizes_buffer.data(),
+                         size);
 
     auto temp_offsets = make_device_buffer<int32_t[]>(queue, m_extents.keys + 1);
     alpaka::memset(queue, temp_offsets, 0u, 1u);
@@ -468,15 +581,120 @@ namespace clue {
     alpaka::memcpy(queue,
                    make_device_view(alpaka::getDev(queue), m_offsets.data(), m_extents.keys + 1),
                    temp_offsets);
-    alpaka::exec<TAcc>(queue,
-                       workdiv,
-                       detail::KernelFillAssociator{},
-                       m_indexes.data(),
-                       bin_buffer.data(),
-                       temp_offsets.data(),
-                       m_extents.keys,
-                       size);
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelFillAssociator{},
+                         m_indexes.data(),
+                         bin_buffer.data(),
+                         temp_offsets.data(),
+                         m_extents.keys,
+                         size);
+    alpaka::wait(queue);
+  }
+
+  template <concepts::device TDev>
+  template <concepts::accelerator TAcc, typename TFunc, concepts::queue TQueue>
+  ALPAKA_FN_HOST inline auto AssociationMap<TDev>::update(size_type size, TFunc func, TQueue& queue)
+      -> size_type {
+    if (m_extents.keys == 0 || size == 0)
+      return 0;
+
+    const auto blocksize = 512;
+    const auto workdiv = make_workdiv<TAcc>(divide_up_by(size, blocksize), blocksize);
+    const auto keys_workdiv =
+        make_workdiv<TAcc>(divide_up_by(m_extents.keys, blocksize), blocksize);
+
+    // the elements without a key keep a negative association
+    auto associations = make_device_buffer<int32_t[]>(queue, size);
+    alpaka::memset(queue, associations, 0xff);
+    internal::exec<TAcc>(queue,
+                         keys_workdiv,
+                         detail::KernelRecordAssociations{},
+                         m_indexes.data(),
+                         m_offsets.data(),
+                         associations.data(),
+                         m_extents.keys);
+    auto new_associations = make_device_buffer<int32_t[]>(queue, size);
+    auto moved = make_device_buffer<int32_t[]>(queue, size);
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelFlagMovedElements<TFunc>{},
+                         associations.data(),
+                         new_associations.data(),
+                         moved.data(),
+                         func,
+                         size);
+
+    internal::algorithm::inclusive_scan(queue, moved.data(), moved.data() + size, moved.data());
+    auto n_moved = int32_t{0};
+    alpaka::memcpy(queue,
+                   make_host_view(n_moved),
+                   make_device_view(alpaka::getDev(queue), moved.data() + size - 1, 1u));
+    alpaka::wait(queue);
+    if (n_moved == 0)
+      return 0;
+
+    auto moved_elements = make_device_buffer<int32_t[]>(queue, n_moved);
+    internal::exec<TAcc>(queue,
+                         workdiv,
+                         detail::KernelCompactMovedElements{},
+                         moved.data(),
+                         moved_elements.data(),
+                         size);
+
+    auto sizes_buffer = make_device_buffer<int32_t[]>(queue, m_extents.keys);
+    internal::exec<TAcc>(queue,
+                         keys_workdiv,
+                         detail::KernelComputeBinSizes{},
+                         m_offsets.data(),
+                         sizes_buffer.data(),
+                         m_extents.keys);
+    const auto moved_workdiv = make_workdiv<TAcc>(divide_up_by(n_moved, blocksize), blocksize);
+    internal::exec<TAcc>(queue,
+                         moved_workdiv,
+                         detail::KernelCountMovedElements{},
+                         moved_elements.data(),
+                         associations.data(),
+                         new_associations.data(),
+                         sizes_buffer.data(),
+                         static_cast<std::size_t>(n_moved));
+
+    auto temp_offsets = make_device_buffer<int32_t[]>(queue, m_extents.keys + 1);
+    alpaka::memset(queue, temp_offsets, 0u, 1u);
+    internal::algorithm::inclusive_scan(
+        queue, sizes_buffer.data(), sizes_buffer.data() + m_extents.keys, temp_offsets.data() + 1);
+
+    auto temp_indexes = make_device_buffer<int32_t[]>(queue, m_extents.values);
+    auto cursors = make_device_buffer<int32_t[]>(queue, m_extents.keys);
+    internal::exec<TAcc>(queue,
+                         keys_workdiv,
+                         detail::KernelKeepUnmovedElements{},
+                         m_indexes.data(),
+                         m_offsets.data(),
+                         temp_offsets.data(),
+                         associations.data(),
+                         new_associations.data(),
+                         temp_indexes.data(),
+                         cursors.data(),
+                         m_extents.keys);
+    internal::exec<TAcc>(queue,
+                         moved_workdiv,
+                         detail::KernelAppendMovedElements{},
+                         moved_elements.data(),
+                         new_associations.data(),
+                         temp_indexes.data(),
+                         cursors.data(),
+                         static_cast<std::size_t>(n_moved));
+
+    // the buffers are copied back, so that the views pointing to them stay valid
+    alpaka::memcpy(queue,
+                   make_device_view(alpaka::getDev(queue), m_offsets.data(), m_extents.keys + 1),
+                   temp_offsets);
+    alpaka::memcpy(queue,
+                   make_device_view(alpaka::getDev(queue), m_indexes.data(), m_extents.values),
+                   temp_indexes);
     alpaka::wait(queue);
+    return static_cast<size_type>(n_moved);
   }
 
 }  // namespace clue
@@ -35,6 +35,12 @@ namespace clue::internal {
       return *m_size;
     }
 
+    ALPAKA_FN_ACC constexpr void resize(std::size_t size) {
+      // NOTE: not thread-safe, must be called by a single thread
+      assert(size <= m_capacity);
+      *m_size = size;
+    }
+
     template <clue::concepts::accelerator TAcc>
     ALPAKA_FN_ACC constexpr auto push_back(const TAcc& acc, int32_t value) {
       auto prev = alpaka::atomicAdd(acc, m_size, std::size_t{1});
@@ -0,0 +1,22 @@
+
+#pragma once
+
+#include "CLUEstering/internal/nostd/upper_bound.hpp"
+
+#include <alpaka/alpaka.hpp>
+#include <cstddef>
+
+namespace clue::detail {
+
+  // Returns the event containing the point global_idx, or batch_size if the point is past the
+  // end of the last event. The batched kernels are launched over all the points of the batch, so
+  // that the work is spread evenly across the blocks regardless of the sizes of the events.
+  template <typename TOffset>
+  ALPAKA_FN_ACC inline std::size_t find_event(const TOffset* event_offsets,
+                                              std::size_t batch_size,
+                                              std::size_t global_idx) {
+    const auto* it = nostd::upper_bound(event_offsets, event_offsets + batch_size + 1, global_idx);
+    return static_cast<std::size_t>(it - event_offsets) - 1;
+  }
+
+}  // namespace clue::detail
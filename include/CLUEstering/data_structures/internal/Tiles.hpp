@@ -26,9 +26,13 @@ namespace clue::internal {
     template <clue::concepts::queue TQueue>
     Tiles(TQueue& queue, int32_t n_points, int32_t n_tiles, std::size_t batch_size = 1)
         : m_assoc{AssociationMap<TDev>(n_points, n_tiles * batch_size, queue)},
-          m_minmax{make_device_buffer<CoordinateExtremes<Ndim, value_type>>(queue)},
-          m_tilesizes{make_device_buffer<value_type[Ndim]>(queue)},
+          m_minmax{make_device_buffer<CoordinateExtremes<Ndim, value_type>[]>(queue, batch_size)},
+          m_tilesizes{make_device_buffer<value_type[]>(queue, Ndim * batch_size)},
           m_wrapped{make_device_buffer<uint8_t[Ndim]>(queue)},
+          m_tileextremes{make_device_buffer<CoordinateExtremes<Ndim, value_type>[]>(
+              queue, n_tiles * batch_size)},
+          m_maxrho{make_device_buffer<value_type[]>(queue, n_tiles * batch_size)},
+          m_weightsums{make_device_buffer<value_type[]>(queue, n_tiles * batch_size)},
           m_ntiles{n_tiles},
           m_nperdim{static_cast<int32_t>(std::pow(n_tiles, 1. / Ndim))},
           m_batch_size{batch_size},
@@ -38,9 +42,13 @@ namespace clue::internal {
       m_view.minmax = m_minmax.data();
       m_view.tilesizes = m_tilesizes.data();
       m_view.wrapping = m_wrapped.data();
+      m_view.tileextremes = m_tileextremes.data();
+      m_view.maxrho = m_maxrho.data();
+      m_view.weightsums = m_weightsums.data();
       m_view.npoints = n_points;
       m_view.ntiles = m_ntiles;
       m_view.nperdim = m_nperdim;
+      m_view.sorted = false;
     }
 
     const auto& view() const { return m_view; }
@@ -53,6 +61,12 @@ namespace clue::internal {
                                    int32_t nperdim,
                                    std::size_t batch_size = 1) {
       m_assoc.initialize(npoints, ntiles * batch_size, queue);
+      m_minmax = make_device_buffer<CoordinateExtremes<Ndim, value_type>[]>(queue, batch_size);
+      m_tilesizes = make_device_buffer<value_type[]>(queue, Ndim * batch_size);
+      m_tileextremes =
+          make_device_buffer<CoordinateExtremes<Ndim, value_type>[]>(queue, ntiles * batch_size);
+      m_maxrho = make_device_buffer<value_type[]>(queue, ntiles * batch_size);
+      m_weightsums = make_device_buffer<value_type[]>(queue, ntiles * batch_size);
       m_ntiles = ntiles;
       m_nperdim = nperdim;
       m_batch_size = batch_size;
@@ -62,9 +76,13 @@ namespace clue::internal {
       m_view.minmax = m_minmax.data();
       m_view.tilesizes = m_tilesizes.data();
       m_view.wrapping = m_wrapped.data();
+      m_view.tileextremes = m_tileextremes.data();
+      m_view.maxrho = m_maxrho.data();
+      m_view.weightsums = m_weightsums.data();
       m_view.npoints = npoints;
       m_view.ntiles = ntiles;
       m_view.nperdim = nperdim;
+      m_view.sorted = false;
     }
 
     ALPAKA_FN_HOST void reset(int32_t npoints,
@@ -81,9 +99,13 @@ namespace clue::internal {
       m_view.minmax = m_minmax.data();
       m_view.tilesizes = m_tilesizes.data();
       m_view.wrapping = m_wrapped.data();
+      m_view.tileextremes = m_tileextremes.data();
+      m_view.maxrho = m_maxrho.data();
+      m_view.weightsums = m_weightsums.data();
       m_view.npoints = npoints;
       m_view.ntiles = ntiles;
       m_view.nperdim = nperdim;
+      m_view.sorted = false;
     }
 
     template <typename T>
@@ -113,30 +135,42 @@ namespace clue::internal {
     ALPAKA_FN_HOST void fill(TQueue& queue, PointsDevice<Ndim, TInput, TDev>& d_points) {
       auto dev = alpaka::getDev(queue);
       auto pointsView = d_points.view();
+      // the points of a refilled tile are no longer in the order of their first coordinate
+      m_view.sorted = false;
       m_assoc.template fill<TAcc>(d_points.size(), GetGlobalBin<TInput>(pointsView, m_view), queue);
     }
 
+    // Rebins the points whose tile changed since the last fill, returning how many were moved
+    template <clue::concepts::accelerator TAcc,
+              clue::concepts::queue TQueue,
+              std::floating_point TInput>
+    ALPAKA_FN_HOST std::size_t update(TQueue& queue, PointsDevice<Ndim, TInput, TDev>& d_points) {
+      auto pointsView = d_points.view();
+      m_view.sorted = false;
+      return m_assoc.template update<TAcc>(
+          d_points.size(), GetGlobalBin<TInput>(pointsView, m_view), queue);
+    }
+
     template <clue::concepts::accelerator TAcc,
               clue::concepts::queue TQueue,
               std::floating_point TInput>
     ALPAKA_FN_HOST void fill_batch(TQueue& queue,
                                    PointsDevice<Ndim, TInput, TDev>& d_points,
-                                   const auto& event_offsets,
-                                   std::size_t max_event_size) {
+                                   const auto& event_offsets) {
       auto dev = alpaka::getDev(queue);
       auto pointsView = d_points.view();
+      m_view.sorted = false;
       m_assoc.template fill_batch<TAcc>(queue,
                                         d_points.size(),
                                         GetGlobalBin<TInput>(pointsView, m_view),
-                                        event_offsets,
-                                        max_event_size);
+                                        event_offsets);
     }
 
-    ALPAKA_FN_HOST inline clue::device_buffer<TDev, CoordinateExtremes<Ndim, value_type>> minMax()
-        const {
+    ALPAKA_FN_HOST inline clue::device_buffer<TDev, CoordinateExtremes<Ndim, value_type>[]>
+    minMax() const {
       return m_minmax;
     }
-    ALPAKA_FN_HOST inline clue::device_buffer<TDev, value_type[Ndim]> tileSize() const {
+    ALPAKA_FN_HOST inline clue::device_buffer<TDev, value_type[]> tileSize() const {
       return m_tilesizes;
     }
     ALPAKA_FN_HOST inline clue::device_buffer<TDev, uint8_t[Ndim]> wrapped() const {
@@ -149,11 +183,19 @@ namespace clue::internal {
 
     ALPAKA_FN_HOST inline constexpr auto extents() const { return m_assoc.extents(); }
 
+    // Number of events whose extremes and tile sizes fit in the allocated buffers
+    ALPAKA_FN_HOST inline auto batchCapacity() const {
+      return static_cast<std::size_t>(alpaka::getExtents(m_minmax)[0]);
+    }
+
   private:
     AssociationMap<TDev> m_assoc;
-    device_buffer<TDev, CoordinateExtremes<Ndim, value_type>> m_minmax;
-    device_buffer<TDev, value_type[Ndim]> m_tilesizes;
+    device_buffer<TDev, CoordinateExtremes<Ndim, value_type>[]> m_minmax;
+    device_buffer<TDev, value_type[]> m_tilesizes;
     device_buffer<TDev, uint8_t[Ndim]> m_wrapped;
+    device_buffer<TDev, CoordinateExtremes<Ndim, value_type>[]> m_tileextremes;
+    device_buffer<TDev, value_type[]> m_maxrho;
+    device_buffer<TDev, value_type[]> m_weightsums;
     int32_t m_ntiles;
     int32_t m_nperdim;
     std::size_t m_batch_size;
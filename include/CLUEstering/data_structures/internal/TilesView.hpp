@@ -22,9 +22,13 @@ namespace clue::internal {
     CoordinateExtremes<Ndim, TData>* minmax;
     TData* tilesizes;
     uint8_t* wrapping;
+    CoordinateExtremes<Ndim, TData>* tileextremes;
+    TData* maxrho;
+    TData* weightsums;
     int32_t npoints;
     int32_t ntiles;
     int32_t nperdim;
+    bool sorted;
 
     ALPAKA_FN_ACC inline constexpr const auto* minMax() const { return minmax; }
     ALPAKA_FN_ACC inline constexpr auto* minMax() { return minmax; }
@@ -35,30 +39,50 @@ namespace clue::internal {
     ALPAKA_FN_ACC inline constexpr const auto* wrapped() const { return wrapping; }
     ALPAKA_FN_ACC inline constexpr auto* wrapped() { return wrapping; }
 
-    ALPAKA_FN_ACC inline constexpr auto getBin(TData coord, int dim) const {
-      int coord_bin;
-      if (wrapping[dim]) {
-        coord_bin =
-            static_cast<int>((normalizeCoordinate(coord, dim) - minmax->min(dim)) / tilesizes[dim]);
-      } else {
-        coord_bin = static_cast<int>((coord - minmax->min(dim)) / tilesizes[dim]);
-      }
+    ALPAKA_FN_ACC inline constexpr const auto* tileExtremes() const { return tileextremes; }
+    ALPAKA_FN_ACC inline constexpr auto* tileExtremes() { return tileextremes; }
+
+    ALPAKA_FN_ACC inline constexpr const auto* maxRho() const { return maxrho; }
+    ALPAKA_FN_ACC inline constexpr auto* maxRho() { return maxrho; }
+
+    ALPAKA_FN_ACC inline constexpr const auto* weightSums() const { return weightsums; }
+    ALPAKA_FN_ACC inline constexpr auto* weightSums() { return weightsums; }
+
+    // Periodic coordinates are padded with a layer of ghost bins, as wide as the grid, on each side.
+    // The ghost bins refer to the tiles on the opposite side of the grid, so the search boxes of
+    // periodic and non-periodic coordinates are handled in the same way.
+    ALPAKA_FN_ACC inline constexpr int32_t padding(int dim) const { return wrapping[dim] * nperdim; }
+
+    // Returns the bin of a coordinate, shifted by the ghost bins of its dimension.
+    // In a batch every event has its own extremes and tile sizes, stored contiguously by event.
+    // Periodic coordinates are not wrapped into the range: those further than one period outside
+    // of it are clamped to the outermost ghost bins, like the non-periodic ones to the edge bins.
+    ALPAKA_FN_ACC inline constexpr auto getBin(TData coord, int dim, std::size_t event = 0) const {
+      // shifting by the padding before truncating keeps the ghost bins on the lower side
+      // from being rounded towards zero
+      int coord_bin = static_cast<int>(
+          (coord - minmax[event].min(dim)) / tilesizes[event * Ndim + dim] + padding(dim));
 
       // Address the cases of underflow and overflow
-      coord_bin = math::min(coord_bin, nperdim - 1);
+      coord_bin = math::min(coord_bin, nperdim + 2 * padding(dim) - 1);
       coord_bin = math::max(coord_bin, 0);
 
       return coord_bin;
     }
 
+    // Maps a bin shifted by the ghost bins back to the bin of the tile it refers to
+    ALPAKA_FN_ACC inline constexpr int32_t unpadBin(int32_t padded_bin) const {
+      return padded_bin - nperdim * ((padded_bin >= nperdim) + (padded_bin >= 2 * nperdim));
+    }
+
     ALPAKA_FN_ACC inline constexpr int getGlobalBin(const TData* coords,
                                                     std::size_t event = 0) const {
       int global_bin = 0;
       for (auto dim = 0u; dim != Ndim - 1; ++dim) {
-        global_bin +=
-            math::pow(static_cast<TData>(nperdim), Ndim - dim - 1) * getBin(coords[dim], dim);
+        global_bin += math::pow(static_cast<TData>(nperdim), Ndim - dim - 1) *
+                      unpadBin(getBin(coords[dim], dim, event));
       }
-      global_bin += getBin(coords[Ndim - 1], Ndim - 1);
+      global_bin += unpadBin(getBin(coords[Ndim - 1], Ndim - 1, event));
       global_bin += event * ntiles;
       return global_bin;
     }
@@ -67,20 +91,20 @@ namespace clue::internal {
                                                          std::size_t event = 0) const {
       int32_t globalBin = 0;
       for (auto dim = 0u; dim != Ndim; ++dim) {
-        auto bin_i = wrapping[dim] ? (Bins[dim] % nperdim) : Bins[dim];
-        globalBin += math::pow(static_cast<TData>(nperdim), Ndim - dim - 1) * bin_i;
+        globalBin += math::pow(static_cast<TData>(nperdim), Ndim - dim - 1) * unpadBin(Bins[dim]);
       }
       globalBin += event * ntiles;
       return globalBin;
     }
 
     ALPAKA_FN_ACC inline void searchBox(const SearchBoxExtremes<Ndim, TData>& searchbox_extremes,
-                                        SearchBoxBins<Ndim>& searchbox_bins) {
+                                        SearchBoxBins<Ndim>& searchbox_bins,
+                                        std::size_t event = 0) {
       for (auto dim = 0u; dim != Ndim; ++dim) {
-        auto infBin = getBin(searchbox_extremes[dim][0], dim);
-        auto supBin = getBin(searchbox_extremes[dim][1], dim);
-        if (wrapping[dim] and infBin > supBin)
-          supBin += nperdim;
+        auto infBin = getBin(searchbox_extremes[dim][0], dim, event);
+        auto supBin = getBin(searchbox_extremes[dim][1], dim, event);
+        // a periodic search box never visits the same tile twice
+        supBin = math::min(supBin, infBin + nperdim - 1);
 
         searchbox_bins[dim] = nostd::make_array(infBin, supBin);
       }
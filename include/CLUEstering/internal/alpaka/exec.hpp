@@ -0,0 +1,48 @@
+
+#pragma once
+
+#include "CLUEstering/core/detail/defines.hpp"
+
+#include <alpaka/alpaka.hpp>
+#include <utility>
+
+// the backend whose resources are controlled is chosen in the same order as ALPAKA_BACKEND
+#if defined(ALPAKA_ACC_GPU_CUDA_ENABLED) || defined(ALPAKA_ACC_GPU_HIP_ENABLED) || \
+    defined(ALPAKA_ACC_SYCL_ENABLED)
+#elif defined(ALPAKA_ACC_CPU_B_TBB_T_SEQ_ENABLED)
+#define CLUE_TBB_EXECUTION_SCOPE
+#include <oneapi/tbb/task_arena.h>
+#elif defined(ALPAKA_ACC_CPU_B_OMP2_T_SEQ_ENABLED)
+#define CLUE_OMP_EXECUTION_SCOPE
+#endif
+
+namespace clue::internal {
+
+#ifdef CLUE_TBB_EXECUTION_SCOPE
+  // The arena of the execution scope opened by the calling thread, if any
+  inline thread_local tbb::task_arena* current_arena = nullptr;
+#endif
+
+  // Enqueues a kernel like alpaka::exec. With the TBB backend the kernels launched inside an
+  // execution scope run in its arena, since the thread of the non-blocking queue would otherwise
+  // run them in its own arena with all the threads of the process.
+  template <typename TAcc, typename TQueue, typename TWorkDiv, typename TKernel, typename... TArgs>
+  inline void exec(TQueue& queue,
+                   const TWorkDiv& work_division,
+                   const TKernel& kernel,
+                   TArgs&&... args) {
+#ifdef CLUE_TBB_EXECUTION_SCOPE
+    if (current_arena != nullptr) {
+      alpaka::enqueue(queue,
+                      [arena = current_arena,
+                       task = alpaka::createTaskKernel<TAcc>(
+                           work_division, kernel, std::forward<TArgs>(args)...)] {
+                        arena->execute([&] { task(); });
+                      });
+      return;
+    }
+#endif
+    alpaka::exec<TAcc>(queue, work_division, kernel, std::forward<TArgs>(args)...);
+  }
+
+}  // namespace clue::internal
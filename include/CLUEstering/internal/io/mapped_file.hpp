@@ -0,0 +1,110 @@
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace clue::internal {
+
+  // Owns a file mapped in memory, whose pages are loaded and written back by the operating system
+  class MappedFile {
+  private:
+    std::byte* m_data = nullptr;
+    std::size_t m_size = 0;
+    int m_fd = -1;
+
+    MappedFile(int fd, std::size_t size, bool writable, const std::string& path) : m_fd{fd} {
+      if (size == 0) {
+        return;
+      }
+      const auto protection = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+      void* data = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+      if (data == MAP_FAILED) {
+        const auto error = errno;
+        close(fd);
+        m_fd = -1;
+        throw std::runtime_error("Failed to map file " + path + ": " + std::strerror(error));
+      }
+      m_data = static_cast<std::byte*>(data);
+      m_size = size;
+    }
+
+    [[noreturn]] static void fail(const std::string& what, const std::string& path, int fd = -1) {
+      const auto error = errno;
+      if (fd != -1)
+        close(fd);
+      throw std::runtime_error(what + " " + path + ": " + std::strerror(error));
+    }
+
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept
+        : m_data{std::exchange(other.m_data, nullptr)},
+          m_size{std::exchange(other.m_size, 0)},
+          m_fd{std::exchange(other.m_fd, -1)} {}
+    MappedFile& operator=(MappedFile&& other) noexcept {
+      std::swap(m_data, other.m_data);
+      std::swap(m_size, other.m_size);
+      std::swap(m_fd, other.m_fd);
+      return *this;
+    }
+    ~MappedFile() {
+      if (m_data != nullptr)
+        munmap(m_data, m_size);
+      if (m_fd != -1)
+        close(m_fd);
+    }
+
+    // Maps an existing file for reading, advising the kernel that it is read sequentially
+    static MappedFile open(const std::string& path) {
+      const int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd == -1)
+        fail("Failed to open file", path);
+      struct stat status;
+      if (fstat(fd, &status) == -1)
+        fail("Failed to read the size of file", path, fd);
+      MappedFile file(fd, static_cast<std::size_t>(status.st_size), false, path);
+      if (file.m_data != nullptr)
+        madvise(file.m_data, file.m_size, MADV_SEQUENTIAL);
+      return file;
+    }
+
+    // Creates, or truncates, a file of the given size and maps it for writing
+    static MappedFile create(const std::string& path, std::size_t size) {
+      const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (fd == -1)
+        fail("Failed to create file", path);
+      if (ftruncate(fd, static_cast<off_t>(size)) == -1)
+        fail("Failed to resize file", path, fd);
+      return MappedFile(fd, size, true, path);
+    }
+
+    // Creates a file that is removed as soon as it is mapped, used for temporary data that
+    // doesn't fit in memory
+    static MappedFile scratch(const std::string& path, std::size_t size) {
+      auto file = create(path, size);
+      unlink(path.c_str());
+      return file;
+    }
+
+    std::size_t size() const { return m_size; }
+
+    template <typename T>
+    std::span<T> as() const {
+      return std::span<T>(reinterpret_cast<T*>(m_data), m_size / sizeof(T));
+    }
+  };
+
+}  // namespace clue::internal
@@ -0,0 +1,26 @@
+
+#pragma once
+
+#include <alpaka/alpaka.hpp>
+#include <cstddef>
+
+namespace clue::nostd {
+
+  // Device-compatible replacement of std::upper_bound over a sorted contiguous range
+  template <typename T, typename U>
+  ALPAKA_FN_HOST_ACC constexpr const T* upper_bound(const T* first, const T* last, const U& value) {
+    auto count = static_cast<std::ptrdiff_t>(last - first);
+    while (count > 0) {
+      const auto step = count / 2;
+      const auto* it = first + step;
+      if (!(value < *it)) {
+        first = it + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+}  // namespace clue::nostd
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+namespace test {
+
+  // Sizes used to split batched_data_1024.csv into events of different sizes, including events
+  // larger than a block and an event smaller than a tile
+  inline const std::vector<uint32_t> mixed_event_sizes{
+      500, 1024, 2000, 24, 1024, 1024, 1024, 1024, 1024, 1572};
+
+  // The points of each event copied into their own buffer, together with the results of
+  // clustering each event on its own, which are the reference for the batched clustering
+  struct ReferenceEvents {
+    std::vector<uint32_t> sizes;
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<int>> labels;
+    std::vector<std::size_t> n_clusters;
+  };
+
+  // Splits the points into consecutive events and clusters each of them with the clusterer
+  // returned by make_clusterer(event)
+  template <std::size_t Ndim, typename TFunc>
+  inline ReferenceEvents reference_events(clue::Queue& queue,
+                                          const clue::PointsHost<Ndim>& points,
+                                          std::span<const uint32_t> event_sizes,
+                                          TFunc&& make_clusterer) {
+    ReferenceEvents events;
+    events.sizes.assign(event_sizes.begin(), event_sizes.end());
+    std::size_t first = 0;
+    for (auto event = 0u; event < event_sizes.size(); ++event) {
+      const auto event_size = event_sizes[event];
+      std::vector<float> input((Ndim + 1) * event_size);
+      for (auto dim = 0u; dim < Ndim; ++dim)
+        std::ranges::copy(points.coords(dim).subspan(first, event_size),
+                          input.begin() + dim * event_size);
+      std::ranges::copy(points.weights().subspan(first, event_size),
+                        input.begin() + Ndim * event_size);
+
+      std::vector<int> output(event_size);
+      clue::PointsHost<Ndim> h_event(queue, event_size, input.data(), output.data());
+      auto algo = make_clusterer(event);
+      algo.make_clusters(queue, h_event);
+
+      events.n_clusters.push_back(h_event.n_clusters());
+      events.inputs.push_back(std::move(input));
+      events.labels.push_back(std::move(output));
+      first += event_size;
+    }
+    return events;
+  }
+
+  // Checks the labels of a batched clustering against the reference, where the cluster indexes
+  // of each event are shifted by the number of clusters of the events before it
+  inline void check_batched_labels(std::span<const int> batched_labels,
+                                   const ReferenceEvents& reference) {
+    std::size_t first = 0;
+    int cluster_offset = 0;
+    for (auto event = 0u; event < reference.sizes.size(); ++event) {
+      CAPTURE(event);
+      const auto& labels = reference.labels[event];
+      for (auto i = 0u; i < labels.size(); ++i)
+        CHECK(batched_labels[first + i] == ((labels[i] >= 0) ? cluster_offset + labels[i] : -1));
+      first += labels.size();
+      cluster_offset += static_cast<int>(reference.n_clusters[event]);
+    }
+  }
+
+}  // namespace test
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <map>
+#include <span>
+
+namespace test {
+
+  // Checks that two labellings describe the same clusters, up to a renumbering
+  inline bool same_clusters(std::span<const int> lhs, std::span<const int> rhs) {
+    if (lhs.size() != rhs.size())
+      return false;
+    std::map<int, int> forward, backward;
+    for (auto i = 0u; i < lhs.size(); ++i) {
+      if ((lhs[i] == -1) != (rhs[i] == -1))
+        return false;
+      if (lhs[i] == -1)
+        continue;
+      const auto [it, inserted] = forward.try_emplace(lhs[i], rhs[i]);
+      const auto [rit, rinserted] = backward.try_emplace(rhs[i], lhs[i]);
+      if (it->second != rhs[i] || rit->second != lhs[i])
+        return false;
+    }
+    return true;
+  }
+
+}  // namespace test
@@ -0,0 +1,158 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+struct Rows {
+  std::vector<float> coordinates;
+  std::vector<float> weights;
+  std::vector<int> labels;
+
+  // Copies a range of rows of the points, with the coordinates in SoA format
+  Rows(const clue::PointsHost<2>& points, std::size_t first, std::size_t n_rows)
+      : coordinates(2 * n_rows), weights(n_rows), labels(n_rows) {
+    for (auto i = 0u; i < n_rows; ++i) {
+      coordinates[i] = points.coords(0)[first + i];
+      coordinates[n_rows + i] = points.coords(1)[first + i];
+      weights[i] = points.weights()[first + i];
+    }
+  }
+
+  clue::PointsHost<2> points(clue::Queue& queue) {
+    return clue::PointsHost<2>(queue,
+                               static_cast<int32_t>(weights.size()),
+                               coordinates.data(),
+                               weights.data(),
+                               labels.data());
+  }
+  clue::Point<2, float> operator[](std::size_t i) const {
+    return {coordinates[i], coordinates[weights.size() + i], weights[i]};
+  }
+};
+
+// Labels the new points comparing them with all the reference points, with the flat kernel of
+// height 0.5 and the seeding distance equal to the density radius
+std::vector<int> expected_labels(
+    const Rows& reference, const Rows& points, float dc, float rhoc, float outlier) {
+  const clue::EuclideanMetric<2, float> metric;
+  const auto n_reference = reference.weights.size();
+  std::vector<float> rho(n_reference, 0.f);
+  for (auto i = 0u; i < n_reference; ++i) {
+    for (auto j = 0u; j < n_reference; ++j) {
+      if (metric(reference[i], reference[j]) <= dc)
+        rho[i] += (i == j ? 1.f : .5f) * reference.weights[j];
+    }
+  }
+
+  std::vector<int> labels;
+  for (auto i = 0u; i < points.weights.size(); ++i) {
+    auto rho_i = points.weights[i];
+    for (auto j = 0u; j < n_reference; ++j) {
+      if (metric(points[i], reference[j]) <= dc)
+        rho_i += .5f * reference.weights[j];
+    }
+    const auto radius = (rho_i >= rhoc) ? dc : outlier;
+    auto delta = std::numeric_limits<float>::max();
+    int nearest_higher = -1;
+    for (auto j = 0u; j < n_reference; ++j) {
+      if (rho[j] < rho_i || (rho[j] == rho_i && rho[j] <= 0.f))
+        continue;
+      const auto distance = metric(points[i], reference[j]);
+      if (distance <= radius &&
+          (distance < delta ||
+           (distance == delta && (rho[j] > rho[nearest_higher] ||
+                                  (rho[j] == rho[nearest_higher] &&
+                                   static_cast<int>(j) > nearest_higher))))) {
+        delta = distance;
+        nearest_higher = static_cast<int>(j);
+      }
+    }
+    labels.push_back(nearest_higher >= 0 ? reference.labels[nearest_higher] : -1);
+  }
+  return labels;
+}
+
+TEST_CASE("Test assigning new points to the clusters of the last run") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  const clue::PointsHost<2> input = clue::read_csv<2, float>(queue, test_file_path);
+  const float dc{1.3f}, rhoc{5.f}, outlier{2.f};
+
+  SUBCASE("Reference points clustered with the tiles") {
+    Rows reference(input, 0, 4000);
+    auto h_reference = reference.points(queue);
+    clue::PointsDevice<2> d_reference(queue, h_reference.size());
+
+    for (const bool separate_tiles : {false, true}) {
+      clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+      algo.setSeparateNearestHigherTiles(separate_tiles);
+      algo.setSortedTiles(separate_tiles);
+      algo.make_clusters(queue, h_reference, d_reference);
+      CHECK(h_reference.n_clusters() > 1);
+
+      Rows points(input, 4000, 500);
+      auto h_points = points.points(queue);
+      algo.assign(queue, d_reference, h_points);
+      const auto expected = expected_labels(reference, points, dc, rhoc, outlier);
+      CHECK(points.labels == expected);
+      CHECK(std::ranges::count(points.labels, -1) < 500);
+
+      // the points are assigned in the same way on the device
+      clue::PointsDevice<2> d_points(queue, h_points.size());
+      clue::copyToDevice(queue, d_points, h_points);
+      algo.assign(queue, d_reference, d_points);
+      clue::copyToHost(queue, h_points, d_points);
+      CHECK(points.labels == expected);
+    }
+  }
+  SUBCASE("Reference points other than the last clustered ones") {
+    Rows reference(input, 0, 4000);
+    auto h_reference = reference.points(queue);
+    clue::PointsDevice<2> d_reference(queue, h_reference.size());
+    clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+    algo.make_clusters(queue, h_reference, d_reference);
+
+    // the tiles of the last run hold as many points, but not the reference ones
+    Rows other(input, 8000, 4000);
+    auto h_other = other.points(queue);
+    clue::PointsDevice<2> d_other(queue, h_other.size());
+    algo.make_clusters(queue, h_other, d_other);
+
+    Rows points(input, 4000, 500);
+    auto h_points = points.points(queue);
+    algo.assign(queue, d_reference, h_points);
+    CHECK(points.labels == expected_labels(reference, points, dc, rhoc, outlier));
+  }
+  SUBCASE("Reference points clustered comparing all the pairs") {
+    Rows reference(input, 0, 200);
+    auto h_reference = reference.points(queue);
+    clue::PointsDevice<2> d_reference(queue, h_reference.size());
+    clue::Clusterer<2> algo(queue, dc, 2.f, outlier);
+    algo.setBruteForceThreshold(h_reference.size() + 1);
+    algo.make_clusters(queue, h_reference, d_reference);
+
+    Rows points(input, 200, 100);
+    auto h_points = points.points(queue);
+    algo.assign(queue, d_reference, h_points);
+    CHECK(points.labels == expected_labels(reference, points, dc, 2.f, outlier));
+  }
+}
+
+TEST_CASE("Test assigning points without a clustered reference") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_1024.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsDevice<2> d_reference(queue, h_points.size());
+  clue::Clusterer<2> algo(queue, 1.3f, 5.f, 2.f);
+  CHECK_THROWS_AS(algo.assign(queue, d_reference, h_points), std::runtime_error);
+}
@@ -5,6 +5,8 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 
+#include "batched_events.hpp"
+
 TEST_CASE("Test batched clustering with fixed batch size") {
   SUBCASE("Test from host points") {
     const auto device = clue::get_device(0u);
@@ -19,18 +21,25 @@ TEST_CASE("Test batched clustering with fixed batch size") {
     clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
     const std::size_t batch_size = 1024;
 
-    std::vector<uint32_t> event_sizes(10, batch_size);
-    algo.make_clusters(queue, h_points, d_points, event_sizes);
-    alpaka::wait(queue);
-
     auto truth =
         clue::read_output<2, float>(queue, "../../../data/truth_files/data_1024_truth.csv");
     auto truth_n_clusters = clue::detail::compute_nclusters(truth.clusterIndexes());
-    auto n_clusters = clue::detail::compute_nclusters(h_points.clusterIndexes());
-    CHECK(n_clusters == truth_n_clusters * 10);
 
-    auto sample_cluster_associations = algo.getSampleAssociations(queue, h_points);
-    CHECK(sample_cluster_associations.size() == 10);
+    // the events fit in a block, so both the block-per-event and the tiled kernels can be used
+    for (const bool block_per_event : {true, false}) {
+      CAPTURE(block_per_event);
+      algo.setBlockPerEvent(block_per_event);
+
+      std::vector<uint32_t> event_sizes(10, batch_size);
+      algo.make_clusters(queue, h_points, d_points, event_sizes);
+      alpaka::wait(queue);
+
+      auto n_clusters = clue::detail::compute_nclusters(h_points.clusterIndexes());
+      CHECK(n_clusters == truth_n_clusters * 10);
+
+      auto sample_cluster_associations = algo.getSampleAssociations(queue, h_points);
+      CHECK(sample_cluster_associations.size() == 10);
+    }
   }
   SUBCASE("Test from device points") {
     const auto device = clue::get_device(0u);
@@ -41,26 +50,187 @@ TEST_CASE("Test batched clustering with fixed batch size") {
     const auto n_points = h_points.size();
 
     clue::PointsDevice<2> d_points(queue, n_points);
-    clue::copyToDevice(queue, d_points, h_points);
-    alpaka::wait(queue);
 
     const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
     clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
     const std::size_t batch_size = 1024;
 
-    std::vector<uint32_t> event_sizes(10, batch_size);
-    algo.make_clusters(queue, d_points, event_sizes);
-
-    clue::copyToHost(queue, h_points, d_points);
-    alpaka::wait(queue);
-
     auto truth =
         clue::read_output<2, float>(queue, "../../../data/truth_files/data_1024_truth.csv");
     auto truth_n_clusters = clue::detail::compute_nclusters(truth.clusterIndexes());
-    auto n_clusters = clue::detail::compute_nclusters(h_points.clusterIndexes());
-    CHECK(n_clusters == truth_n_clusters * 10);
 
-    auto sample_cluster_associations = algo.getSampleAssociations(queue, d_points);
-    CHECK(sample_cluster_associations.size() == 10);
+    for (const bool block_per_event : {true, false}) {
+      CAPTURE(block_per_event);
+      algo.setBlockPerEvent(block_per_event);
+      clue::copyToDevice(queue, d_points, h_points);
+      alpaka::wait(queue);
+
+      std::vector<uint32_t> event_sizes(10, batch_size);
+      algo.make_clusters(queue, d_points, event_sizes);
+
+      clue::copyToHost(queue, h_points, d_points);
+      alpaka::wait(queue);
+
+      auto n_clusters = clue::detail::compute_nclusters(h_points.clusterIndexes());
+      CHECK(n_clusters == truth_n_clusters * 10);
+
+      auto sample_cluster_associations = algo.getSampleAssociations(queue, d_points);
+      CHECK(sample_cluster_associations.size() == 10);
+    }
+  }
+}
+
+TEST_CASE("Test batched clustering against the clustering of the single events") {
+  const auto device = clue::get_device(0u);
+  clue::Queue queue(device);
+
+  clue::PointsHost<2> h_points =
+      clue::read_csv<2, float>(queue, "../../../data/batched_data_1024.csv");
+  const auto n_points = h_points.size();
+  clue::PointsDevice<2> d_points(queue, n_points);
+
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+
+  auto check_events = [&](const std::vector<uint32_t>& event_sizes) {
+    algo.make_clusters(queue, h_points, d_points, event_sizes);
+    alpaka::wait(queue);
+    const auto reference = test::reference_events(queue, h_points, event_sizes, [&](auto) {
+      return clue::Clusterer<2>(queue, dc, rhoc, outlier);
+    });
+    test::check_batched_labels(h_points.clusterIndexes(), reference);
+  };
+
+  SUBCASE("Events fitting in a block") { check_events(std::vector<uint32_t>(10, 1024)); }
+  SUBCASE("Events larger than a block") { check_events(test::mixed_event_sizes); }
+  SUBCASE("Skewed event sizes") { check_events({16, 8000, 32, 64, 16, 1000, 8, 1104}); }
+  SUBCASE("Events in distant regions") {
+    // each event gets its own tile grid, so moving the events apart must not change the clusters
+    const auto& event_sizes = test::mixed_event_sizes;
+    auto first = 0u;
+    for (auto event = 0u; event < event_sizes.size(); ++event) {
+      for (auto dim = 0u; dim < 2u; ++dim) {
+        for (auto& coord : h_points.coords(dim).subspan(first, event_sizes[event]))
+          coord += 100.f * event * (dim + 1);
+      }
+      first += event_sizes[event];
+    }
+    check_events(event_sizes);
+  }
+}
+
+TEST_CASE("Test batched clustering with the event sizes on the device") {
+  const auto device = clue::get_device(0u);
+  clue::Queue queue(device);
+
+  clue::PointsHost<2> h_points =
+      clue::read_csv<2, float>(queue, "../../../data/batched_data_1024.csv");
+  const auto n_points = h_points.size();
+  clue::PointsDevice<2> d_points(queue, n_points);
+
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+
+  const auto& event_sizes = test::mixed_event_sizes;
+  std::vector<uint32_t> event_offsets(event_sizes.size() + 1, 0);
+  std::inclusive_scan(event_sizes.begin(), event_sizes.end(), event_offsets.begin() + 1);
+
+  algo.make_clusters(queue, h_points, d_points, event_sizes);
+  alpaka::wait(queue);
+  const std::vector<int> expected(h_points.clusterIndexes().begin(),
+                                  h_points.clusterIndexes().end());
+
+  auto d_event_sizes = clue::make_device_buffer<uint32_t[]>(queue, event_sizes.size());
+  alpaka::memcpy(
+      queue, d_event_sizes, clue::make_host_view(event_sizes.data(), event_sizes.size()));
+  auto d_event_offsets = clue::make_device_buffer<uint32_t[]>(queue, event_offsets.size());
+  alpaka::memcpy(
+      queue, d_event_offsets, clue::make_host_view(event_offsets.data(), event_offsets.size()));
+
+  SUBCASE("From the event sizes") {
+    algo.make_clusters(queue,
+                       d_points,
+                       clue::DeviceEventSizes{{d_event_sizes.data(), event_sizes.size()}});
+  }
+  SUBCASE("From the event offsets") {
+    algo.make_clusters(queue,
+                       d_points,
+                       clue::DeviceEventOffsets{{d_event_offsets.data(), event_offsets.size()}});
+  }
+  clue::copyToHost(queue, h_points, d_points);
+  alpaka::wait(queue);
+  CHECK(std::ranges::equal(h_points.clusterIndexes(), expected));
+  CHECK(algo.getSampleAssociations(queue, d_points).size() == event_sizes.size());
+}
+
+TEST_CASE("Test batched clustering with per-event parameters") {
+  const auto device = clue::get_device(0u);
+  clue::Queue queue(device);
+
+  clue::PointsHost<2> h_points =
+      clue::read_csv<2, float>(queue, "../../../data/batched_data_1024.csv");
+  const auto n_points = h_points.size();
+  clue::PointsDevice<2> d_points(queue, n_points);
+
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+
+  auto make_parameters = [](std::size_t batch_size) {
+    std::vector<clue::EventParameters<float>> parameters(batch_size);
+    for (auto event = 0u; event < batch_size; ++event) {
+      const auto radius = 1.f + 0.3f * (event % 3);
+      parameters[event] = {radius, 5.f + 5.f * (event % 4), radius, radius};
+    }
+    return parameters;
+  };
+
+  auto check_events = [&](const std::vector<uint32_t>& event_sizes) {
+    const auto parameters = make_parameters(event_sizes.size());
+    algo.make_clusters(queue, h_points, d_points, event_sizes, parameters);
+    alpaka::wait(queue);
+    const auto reference = test::reference_events(queue, h_points, event_sizes, [&](auto event) {
+      const auto& event_parameters = parameters[event];
+      return clue::Clusterer<2>(queue,
+                                event_parameters.density_radius,
+                                event_parameters.min_density,
+                                event_parameters.outlier_distance,
+                                event_parameters.seeding_distance);
+    });
+    test::check_batched_labels(h_points.clusterIndexes(), reference);
+  };
+
+  SUBCASE("Events fitting in a block") { check_events(std::vector<uint32_t>(10, 1024)); }
+  SUBCASE("Events larger than a block") { check_events(test::mixed_event_sizes); }
+  SUBCASE("Uniform parameters") {
+    const auto& event_sizes = test::mixed_event_sizes;
+    algo.make_clusters(queue, h_points, d_points, event_sizes);
+    alpaka::wait(queue);
+    const std::vector<int> expected(h_points.clusterIndexes().begin(),
+                                    h_points.clusterIndexes().end());
+
+    const std::vector<clue::EventParameters<float>> parameters(event_sizes.size(),
+                                                               {dc, rhoc, outlier, dc});
+    auto d_event_sizes = clue::make_device_buffer<uint32_t[]>(queue, event_sizes.size());
+    alpaka::memcpy(
+        queue, d_event_sizes, clue::make_host_view(event_sizes.data(), event_sizes.size()));
+    auto d_parameters =
+        clue::make_device_buffer<clue::EventParameters<float>[]>(queue, parameters.size());
+    alpaka::memcpy(
+        queue, d_parameters, clue::make_host_view(parameters.data(), parameters.size()));
+    const clue::DeviceEventParameters<float> d_event_parameters{
+        {d_parameters.data(), parameters.size()}};
+    algo.make_clusters(queue,
+                       d_points,
+                       clue::DeviceEventSizes{{d_event_sizes.data(), event_sizes.size()}},
+                       d_event_parameters);
+    clue::copyToHost(queue, h_points, d_points);
+    alpaka::wait(queue);
+    CHECK(std::ranges::equal(h_points.clusterIndexes(), expected));
+  }
+  SUBCASE("Mismatching number of parameters") {
+    const std::vector<uint32_t> event_sizes(10, 1024);
+    CHECK_THROWS_AS(
+        algo.make_clusters(queue, h_points, d_points, event_sizes, make_parameters(9)),
+        std::invalid_argument);
   }
 }
@@ -2,6 +2,7 @@
 #include "CLUEstering/CLUEstering.hpp"
 #include "CLUEstering/utils/validation.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <ranges>
 #include <span>
@@ -54,3 +55,21 @@ TEST_CASE("Test Clusterer constructors with invalid parameters") {
     CHECK_THROWS(clue::Clusterer<2>(queue, 1.f, -10.f));
   }
 }
+
+TEST_CASE("Test clustering with limited execution resources") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsHost<2> h_limited = clue::read_csv<2, float>(queue, test_file_path);
+
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points);
+
+  clue::Clusterer<2> limited(queue, dc, rhoc, outlier);
+  limited.setExecutionResources({1, {0}});
+  limited.make_clusters(queue, h_limited);
+
+  CHECK(std::ranges::equal(h_points.clusterIndexes(), h_limited.clusterIndexes()));
+}
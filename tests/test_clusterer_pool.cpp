@@ -0,0 +1,72 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "batched_events.hpp"
+
+TEST_CASE("Test clustering events concurrently with a ClustererPool") {
+  const auto device = clue::get_device(0u);
+  clue::Queue queue(device);
+
+  clue::PointsHost<2> h_points =
+      clue::read_csv<2, float>(queue, "../../../data/batched_data_1024.csv");
+
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  const auto& event_sizes = test::mixed_event_sizes;
+  auto reference = test::reference_events(queue, h_points, event_sizes, [&](auto) {
+    return clue::Clusterer<2>(queue, dc, rhoc, outlier);
+  });
+  auto& inputs = reference.inputs;
+  const auto& expected = reference.labels;
+
+  clue::ClustererPool<2> pool(3, dc, rhoc, outlier);
+  CHECK(pool.size() == 3);
+
+  std::vector<std::vector<int>> outputs;
+  std::vector<clue::PointsHost<2>> events;
+  for (auto event = 0u; event < event_sizes.size(); ++event) {
+    outputs.emplace_back(event_sizes[event]);
+    events.emplace_back(queue, event_sizes[event], inputs[event].data(), outputs[event].data());
+  }
+
+  // the events are submitted from two threads at the same time
+  std::vector<std::future<void>> futures(event_sizes.size());
+  auto submit_events = [&](std::size_t parity) {
+    for (auto event = parity; event < event_sizes.size(); event += 2)
+      futures[event] = pool.submit(events[event]);
+  };
+  std::thread even_thread(submit_events, 0);
+  std::thread odd_thread(submit_events, 1);
+  even_thread.join();
+  odd_thread.join();
+
+  for (auto event = 0u; event < event_sizes.size(); ++event) {
+    futures[event].get();
+    CHECK(events[event].clustered());
+    CHECK(outputs[event] == expected[event]);
+  }
+
+  const auto statistics = pool.statistics();
+  CHECK(statistics.size() == 3);
+  std::size_t n_events = 0, n_points = 0;
+  for (const auto& worker : statistics) {
+    n_events += worker.events;
+    n_points += worker.points;
+    CHECK(worker.pending_points == 0);
+    CHECK(worker.utilization >= 0.);
+    CHECK(worker.utilization <= 1.);
+  }
+  CHECK(n_events == event_sizes.size());
+  CHECK(n_points == std::accumulate(event_sizes.begin(), event_sizes.end(), std::size_t{0}));
+
+  CHECK_THROWS_AS(clue::ClustererPool<2>(0, dc, rhoc, outlier), std::invalid_argument);
+}
@@ -2,9 +2,14 @@
 #include "CLUEstering/CLUEstering.hpp"
 #include "CLUEstering/utils/validation.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <numbers>
 #include <random>
 #include <ranges>
+#include <span>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -269,6 +274,52 @@ TEST_CASE("Test clustering on data with periodic coordinates") {
   }
 }
 
+TEST_CASE("Test periodic coordinates across the seam of the tiles") {
+  auto queue = clue::get_queue(0u);
+
+  // two peaks of decreasing weights along a coordinate of period 10, the first one centred on
+  // the seam between the last and the first tile
+  const float period{10.f}, spacing{.001f};
+  const int half_width{200};
+  std::vector<float> coords, weights;
+  for (const auto centre : {0.f, 5.f}) {
+    for (auto k = -half_width; k <= half_width; ++k) {
+      const auto x = centre + static_cast<float>(k) * spacing;
+      coords.push_back(x < 0.f ? x + period : x);
+      weights.push_back(static_cast<float>(half_width + 1 - std::abs(k)));
+    }
+  }
+  const auto n_points = static_cast<int32_t>(weights.size());
+  std::vector<int> labels(n_points);
+  clue::PointsHost<1> h_points(queue, n_points, coords.data(), weights.data(), labels.data());
+  clue::PointsDevice<1> d_points(queue, n_points);
+
+  const float dc{2.5f * spacing}, rhoc{100.f}, outlier{2.5f * spacing};
+  clue::Clusterer<1> algo(queue, dc, rhoc, outlier);
+  algo.setWrappedCoordinates(1);
+  const auto metric = clue::metrics::PeriodicEuclidean<1>(std::array<float, 1>{period});
+  algo.make_clusters(queue, h_points, d_points, metric);
+
+  const auto peak_size = static_cast<std::size_t>(2 * half_width + 1);
+  const auto seam_peak = std::span{labels}.first(peak_size);
+  const auto inner_peak = std::span{labels}.subspan(peak_size);
+  CHECK(h_points.n_clusters() == 2);
+  CHECK(seam_peak[0] >= 0);
+  CHECK(std::ranges::all_of(seam_peak, [&](auto label) { return label == seam_peak[0]; }));
+  CHECK(std::ranges::all_of(inner_peak, [&](auto label) { return label == inner_peak[0]; }));
+  CHECK(seam_peak[0] != inner_peak[0]);
+
+  // points outside the range of the clustered ones, by less than a period, are binned in the
+  // ghost tiles on either side of the grid
+  std::vector<float> new_coords{10.0014f, -.0006f}, new_weights{1.f, 1.f};
+  std::vector<int> new_labels(2);
+  clue::PointsHost<1> new_points(
+      queue, 2, new_coords.data(), new_weights.data(), new_labels.data());
+  algo.assign(queue, d_points, new_points, metric);
+  CHECK(new_labels[0] == seam_peak[0]);
+  CHECK(new_labels[1] == seam_peak[0]);
+}
+
 TEST_CASE("Test clustering from constant host points") {
   auto queue = clue::get_queue(0u);
 
@@ -565,3 +616,241 @@ TEST_CASE("Point tags override the index-based tie-break for nearest higher") {
     CHECK(is_seed[0] == 1);
   }
 }
+
+TEST_CASE("Whole-tile density of the flat kernel matches the point-by-point density") {
+  // same values as the FlatKernel, but without declaring itself distance-independent
+  struct PointwiseFlatKernel {
+    using value_type = float;
+    float flat;
+    ALPAKA_FN_HOST_ACC auto operator()(float, int point_id, int j) const {
+      return (point_id == j) ? 1.f : flat;
+    }
+  };
+  static_assert(clue::concepts::distance_independent_kernel<clue::FlatKernel<float>>);
+  static_assert(!clue::concepts::distance_independent_kernel<PointwiseFlatKernel>);
+  static_assert(!clue::concepts::distance_independent_kernel<clue::GaussianKernel<float>>);
+
+  auto queue = clue::get_queue(0u);
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/toyDetector_1000.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  const auto n_points = h_points.size();
+  // the weights of the dataset are all equal, so they are changed to make the order of the sums
+  // and the removal of the self term from the weight of the tile matter
+  for (auto i = 0; i < n_points; ++i)
+    h_points.weights()[i] = .25f + .5f * static_cast<float>(i % 7);
+
+  const float dc{100.f}, rhoc{10.f}, outlier{100.f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  // the weighted metric bounds the distance with the corners of the tiles, but not with a single
+  // coordinate, so the density isn't accumulated pairwise and the shortcut is used on every backend
+  const clue::metrics::WeightedEuclidean<2> metric(1.f, 1.f);
+
+  auto read_rho = [&](clue::PointsDevice<2>& d_points) {
+    std::vector<float> rho(n_points);
+    alpaka::memcpy(
+        queue,
+        clue::make_host_view(rho.data(), n_points),
+        clue::make_device_view(alpaka::getDev(queue), d_points.view().rho().data(), n_points));
+    alpaka::wait(queue);
+    return rho;
+  };
+
+  clue::PointsDevice<2> d_tiled(queue, n_points);
+  algo.make_clusters(queue, h_points, d_tiled, metric, clue::FlatKernel<float>(.5f));
+  const auto tiled_rho = read_rho(d_tiled);
+
+  clue::PointsDevice<2> d_pointwise(queue, n_points);
+  algo.make_clusters(queue, h_points, d_pointwise, metric, PointwiseFlatKernel{.5f});
+  const auto pointwise_rho = read_rho(d_pointwise);
+
+  for (auto i = 0; i < n_points; ++i) {
+    CHECK(tiled_rho[i] == doctest::Approx(pointwise_rho[i]));
+  }
+}
+
+TEST_CASE("Test clustering with tiles sorted by the first coordinate") {
+  auto queue = clue::get_queue(0u);
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/toyDetector_5000.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsHost<2> h_sorted = clue::read_csv<2, float>(queue, test_file_path);
+
+  const float dc{4.5f}, rhoc{2.5f}, outlier{9.f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points);
+
+  SUBCASE("Euclidean metric, using the sorted window") {
+    clue::Clusterer<2> sorted_algo(queue, dc, rhoc, outlier);
+    sorted_algo.setSortedTiles(true);
+    sorted_algo.make_clusters(queue, h_sorted);
+    CHECK(std::ranges::equal(h_points.clusterIndexes(), h_sorted.clusterIndexes()));
+  }
+  SUBCASE("Weighted metric, ignoring the sorted window") {
+    clue::Clusterer<2> sorted_algo(queue, dc, rhoc, outlier);
+    sorted_algo.setSortedTiles(true);
+    sorted_algo.make_clusters(queue, h_sorted, clue::metrics::WeightedEuclidean<2>(1.f, 1.f));
+    CHECK(std::ranges::equal(h_points.clusterIndexes(), h_sorted.clusterIndexes()));
+  }
+}
+
+TEST_CASE("Pairwise density accumulation matches the per-point density") {
+  // same values as the GaussianKernel, but not known to be symmetric
+  struct PointwiseGaussianKernel {
+    using value_type = float;
+    float std;
+    float amplitude;
+    ALPAKA_FN_HOST_ACC auto operator()(float distance, int point_id, int j) const {
+      return (point_id == j) ? 1.f
+                             : amplitude * clue::math::exp(-distance * distance / (2 * std * std));
+    }
+  };
+
+  auto queue = clue::get_queue(0u);
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/toyDetector_5000.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  const auto n_points = h_points.size();
+
+  const float dc{4.5f}, rhoc{2.5f}, outlier{9.f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  algo.setPairwiseDensity(true);
+
+  auto read_rho = [&](clue::PointsDevice<2>& d_points) {
+    std::vector<float> rho(n_points);
+    alpaka::memcpy(
+        queue,
+        clue::make_host_view(rho.data(), n_points),
+        clue::make_device_view(alpaka::getDev(queue), d_points.view().rho().data(), n_points));
+    alpaka::wait(queue);
+    return rho;
+  };
+
+  clue::PointsDevice<2> d_pairwise(queue, n_points);
+  algo.make_clusters(
+      queue, h_points, d_pairwise, clue::metrics::Euclidean<2>{}, clue::GaussianKernel(1.f, 1.f));
+  const auto pairwise_rho = read_rho(d_pairwise);
+
+  clue::PointsDevice<2> d_pointwise(queue, n_points);
+  algo.make_clusters(
+      queue, h_points, d_pointwise, clue::metrics::Euclidean<2>{}, PointwiseGaussianKernel{1.f, 1.f});
+  const auto pointwise_rho = read_rho(d_pointwise);
+
+  for (auto i = 0; i < n_points; ++i) {
+    CHECK(pairwise_rho[i] == doctest::Approx(pointwise_rho[i]));
+  }
+}
+
+TEST_CASE("Test clustering with a separate tile grid for the nearest-higher search") {
+  auto queue = clue::get_queue(0u);
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/toyDetector_5000.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsHost<2> h_separate = clue::read_csv<2, float>(queue, test_file_path);
+
+  const float dc{4.5f}, rhoc{2.5f}, outlier{18.f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points);
+
+  SUBCASE("Unsorted tiles") {
+    clue::Clusterer<2> separate_algo(queue, dc, rhoc, outlier);
+    separate_algo.setSeparateNearestHigherTiles(true);
+    separate_algo.make_clusters(queue, h_separate);
+    CHECK(std::ranges::equal(h_points.clusterIndexes(), h_separate.clusterIndexes()));
+  }
+  SUBCASE("Sorted tiles") {
+    clue::Clusterer<2> separate_algo(queue, dc, rhoc, outlier);
+    separate_algo.setSeparateNearestHigherTiles(true);
+    separate_algo.setSortedTiles(true);
+    separate_algo.make_clusters(queue, h_separate);
+    CHECK(std::ranges::equal(h_points.clusterIndexes(), h_separate.clusterIndexes()));
+  }
+}
+
+TEST_CASE("Cluster indexes of the seeds follow the order of the points") {
+  auto queue = clue::get_queue(0u);
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/toyDetector_5000.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  const auto n_points = h_points.size();
+  clue::PointsDevice<2> d_points(queue, n_points);
+
+  const float dc{4.5f}, rhoc{2.5f}, outlier{9.f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points, d_points);
+
+  std::vector<int32_t> is_seed(n_points);
+  alpaka::memcpy(
+      queue,
+      clue::make_host_view(is_seed.data(), n_points),
+      clue::make_device_view(alpaka::getDev(queue), d_points.view().is_seed().data(), n_points));
+  alpaka::wait(queue);
+
+  const auto cluster_indexes = h_points.clusterIndexes();
+  auto next_cluster = 0;
+  for (auto i = 0; i < n_points; ++i) {
+    if (is_seed[i]) {
+      CHECK(cluster_indexes[i] == next_cluster);
+      ++next_cluster;
+    }
+  }
+  CHECK(next_cluster > 0);
+  CHECK(std::ranges::max(cluster_indexes) == next_cluster - 1);
+}
+
+TEST_CASE("Isolated points are clustered by the density kernels") {
+  auto queue = clue::get_queue(0u);
+  // a group of five points and two isolated points, the second one heavy enough to be a seed
+  const std::vector<float> x{0.f, .1f, 0.f, .1f, .05f, 10.f, 20.f};
+  const std::vector<float> y{0.f, 0.f, .1f, .1f, .05f, 10.f, 20.f};
+  const std::vector<float> weights{1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 5.f};
+  const auto size = static_cast<uint32_t>(x.size());
+  auto input = clue::make_host_buffer<float[]>(queue, 3 * size);
+  std::ranges::copy(x, input.data());
+  std::ranges::copy(y, input.data() + size);
+  std::ranges::copy(weights, input.data() + 2 * size);
+  auto output = clue::make_host_buffer<int[]>(queue, size);
+  clue::PointsHost<2> h_points(queue, size, input.data(), output.data());
+
+  const float dc{1.f}, rhoc{3.f};
+  clue::Clusterer<2> algo(queue, dc, rhoc);
+  SUBCASE("Flat kernel") { algo.make_clusters(queue, h_points); }
+  SUBCASE("Flat kernel with a weighted metric") {
+    algo.make_clusters(queue, h_points, clue::metrics::WeightedEuclidean<2>(1.f, 1.f));
+  }
+
+  const auto cluster_indexes = h_points.clusterIndexes();
+  for (auto i = 1u; i < 5u; ++i)
+    CHECK(cluster_indexes[i] == cluster_indexes[0]);
+  CHECK(cluster_indexes[0] >= 0);
+  CHECK(cluster_indexes[5] == -1);
+  CHECK(cluster_indexes[6] >= 0);
+  CHECK(cluster_indexes[6] != cluster_indexes[0]);
+}
+
+TEST_CASE("Brute-force clustering of small point sets matches the tiled clustering") {
+  auto queue = clue::get_queue(0u);
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/toyDetector_1000.csv";
+  clue::PointsHost<2> h_tiled = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsHost<2> h_brute_force = clue::read_csv<2, float>(queue, test_file_path);
+
+  const float dc{4.5f}, rhoc{2.5f}, outlier{9.f};
+  clue::Clusterer<2> tiled_algo(queue, dc, rhoc, outlier);
+  tiled_algo.setBruteForceThreshold(0);
+  clue::Clusterer<2> brute_force_algo(queue, dc, rhoc, outlier);
+  brute_force_algo.setBruteForceThreshold(h_brute_force.size() + 1);
+
+  SUBCASE("Flat kernel") {
+    tiled_algo.make_clusters(queue, h_tiled);
+    brute_force_algo.make_clusters(queue, h_brute_force);
+  }
+  SUBCASE("Gaussian kernel, device points") {
+    clue::PointsDevice<2> d_tiled(queue, h_tiled.size());
+    clue::PointsDevice<2> d_brute_force(queue, h_brute_force.size());
+    clue::copyToDevice(queue, d_tiled, h_tiled);
+    clue::copyToDevice(queue, d_brute_force, h_brute_force);
+    tiled_algo.make_clusters(
+        queue, d_tiled, clue::metrics::Euclidean<2>{}, clue::GaussianKernel(1.f, 1.f));
+    brute_force_algo.make_clusters(
+        queue, d_brute_force, clue::metrics::Euclidean<2>{}, clue::GaussianKernel(1.f, 1.f));
+    clue::copyToHost(queue, h_tiled, d_tiled);
+    clue::copyToHost(queue, h_brute_force, d_brute_force);
+    alpaka::wait(queue);
+  }
+  CHECK(std::ranges::equal(h_tiled.clusterIndexes(), h_brute_force.clusterIndexes()));
+}
@@ -0,0 +1,88 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "batched_events.hpp"
+
+TEST_CASE("Test packing events with the EventBatcher") {
+  const auto device = clue::get_device(0u);
+  clue::Queue queue(device);
+
+  clue::PointsHost<2> h_points =
+      clue::read_csv<2, float>(queue, "../../../data/batched_data_1024.csv");
+
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+
+  // the reference results are obtained by clustering each event on its own
+  const auto& event_sizes = test::mixed_event_sizes;
+  auto reference = test::reference_events(queue, h_points, event_sizes, [&](auto) {
+    return clue::Clusterer<2>(queue, dc, rhoc, outlier);
+  });
+  auto& inputs = reference.inputs;
+  const auto& expected = reference.labels;
+  const auto& expected_clusters = reference.n_clusters;
+
+  clue::EventBatcher<2> batcher(queue, algo, 4096);
+  CHECK(batcher.capacity() == 4096);
+
+  SUBCASE("Events as host points") {
+    std::vector<std::vector<int>> outputs;
+    std::vector<clue::PointsHost<2>> events;
+    for (auto event = 0u; event < event_sizes.size(); ++event) {
+      outputs.emplace_back(event_sizes[event]);
+      events.emplace_back(queue, event_sizes[event], inputs[event].data(), outputs[event].data());
+    }
+    for (auto& event : events)
+      batcher.push(queue, event);
+    CHECK(batcher.n_points() <= batcher.capacity());
+    batcher.flush(queue);
+    CHECK(batcher.size() == 0);
+    CHECK(batcher.n_points() == 0);
+
+    for (auto event = 0u; event < event_sizes.size(); ++event) {
+      CHECK(events[event].clustered());
+      CHECK(outputs[event] == expected[event]);
+      CHECK(events[event].n_clusters() == expected_clusters[event]);
+    }
+  }
+  SUBCASE("Events as spans") {
+    std::vector<std::vector<int>> outputs;
+    std::vector<std::size_t> n_clusters(event_sizes.size());
+    for (auto event = 0u; event < event_sizes.size(); ++event)
+      outputs.emplace_back(event_sizes[event]);
+    for (auto event = 0u; event < event_sizes.size(); ++event) {
+      const auto event_size = event_sizes[event];
+      const std::span<const float> input{inputs[event]};
+      batcher.push(queue,
+                   input.subspan(0, 2 * event_size),
+                   input.subspan(2 * event_size),
+                   outputs[event],
+                   &n_clusters[event]);
+    }
+    batcher.flush(queue);
+
+    for (auto event = 0u; event < event_sizes.size(); ++event) {
+      CHECK(outputs[event] == expected[event]);
+      CHECK(n_clusters[event] == expected_clusters[event]);
+    }
+  }
+  SUBCASE("Invalid events") {
+    std::vector<float> coordinates(2 * 5000), weights(5000);
+    std::vector<int> output(5000);
+    CHECK_THROWS_AS(batcher.push(queue, coordinates, weights, output), std::invalid_argument);
+    CHECK_THROWS_AS(batcher.push(queue,
+                                 std::span<const float>{coordinates}.subspan(0, 10),
+                                 std::span<const float>{weights}.subspan(0, 4),
+                                 std::span<int>{output}.subspan(0, 4)),
+                    std::invalid_argument);
+  }
+  CHECK(clue::EventBatcher<2>::capacity_for(1600) == 100);
+}
@@ -0,0 +1,118 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+TEST_CASE("Test the online throughput model") {
+  clue::detail::ThroughputModel model;
+  CHECK_FALSE(model.ready());
+
+  // the time of an event is 1 ms plus 1 us per point
+  for (auto i = 0; i < 20; ++i) {
+    const auto n_points = 100. * (1 + i % 5);
+    model.update(n_points, 1e-3 + 1e-6 * n_points);
+  }
+  CHECK(model.ready());
+  CHECK(model.predict(1000.) == doctest::Approx(2e-3).epsilon(1e-3));
+
+  // with a single event size the time is taken as proportional to the size
+  clue::detail::ThroughputModel proportional;
+  proportional.update(100., 1e-3);
+  CHECK(proportional.predict(200.) == doctest::Approx(2e-3));
+}
+
+TEST_CASE("Test dispatching events across backends with an EventScheduler") {
+  const auto device = clue::get_device(0u);
+  clue::Queue queue(device);
+
+  clue::PointsHost<2> h_points =
+      clue::read_csv<2, float>(queue, "../../../data/batched_data_1024.csv");
+
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+
+  const std::vector<uint32_t> event_sizes{
+      500, 1024, 2000, 24, 1024, 1024, 1024, 1024, 1024, 1572};
+  std::vector<std::vector<float>> inputs;
+  std::vector<std::vector<int>> expected;
+  std::size_t first = 0;
+  for (auto event_size : event_sizes) {
+    std::vector<float> input(3 * event_size);
+    for (auto dim = 0u; dim < 2u; ++dim)
+      std::ranges::copy(h_points.coords(dim).subspan(first, event_size),
+                        input.begin() + dim * event_size);
+    std::ranges::copy(h_points.weights().subspan(first, event_size),
+                      input.begin() + 2 * event_size);
+
+    std::vector<int> output(event_size);
+    clue::PointsHost<2> h_event(queue, event_size, input.data(), output.data());
+    algo.make_clusters(queue, h_event);
+    expected.push_back(std::move(output));
+    inputs.push_back(std::move(input));
+    first += event_size;
+  }
+
+  // both backends run on the same device, but one of them is artificially slowed down
+  auto make_backend = [&](std::string name, std::size_t n_workers, auto delay) {
+    auto clusterers = std::make_shared<std::vector<clue::Clusterer<2>>>();
+    auto queues = std::make_shared<std::vector<clue::Queue>>();
+    for (auto i = 0u; i < n_workers; ++i) {
+      queues->emplace_back(device);
+      clusterers->emplace_back(queues->back(), dc, rhoc, outlier);
+    }
+    return clue::SchedulerBackend<2>{
+        std::move(name), n_workers, [=](std::size_t worker, clue::PointsHost<2>& points) {
+          std::this_thread::sleep_for(delay);
+          (*clusterers)[worker].make_clusters((*queues)[worker], points);
+        }};
+  };
+
+  const auto n_rounds = 4u;
+  std::vector<std::vector<int>> outputs;
+  std::vector<clue::PointsHost<2>> events;
+  for (auto round = 0u; round < n_rounds; ++round) {
+    for (auto event = 0u; event < event_sizes.size(); ++event)
+      outputs.emplace_back(event_sizes[event]);
+  }
+  for (auto i = 0u; i < outputs.size(); ++i) {
+    const auto event = i % event_sizes.size();
+    events.emplace_back(queue, event_sizes[event], inputs[event].data(), outputs[i].data());
+  }
+
+  std::vector<clue::EventScheduler<2>::BackendStatistics> statistics;
+  {
+    clue::EventScheduler<2> scheduler(
+        {make_backend("fast", 2, std::chrono::milliseconds(0)),
+         make_backend("slow", 1, std::chrono::milliseconds(50))});
+    CHECK(scheduler.size() == 2);
+
+    std::vector<std::future<void>> futures;
+    for (auto& event : events)
+      futures.push_back(scheduler.submit(event));
+    for (auto& future : futures)
+      future.get();
+    statistics = scheduler.statistics();
+  }
+
+  for (auto i = 0u; i < outputs.size(); ++i)
+    CHECK(outputs[i] == expected[i % event_sizes.size()]);
+
+  REQUIRE(statistics.size() == 2);
+  CHECK(statistics[0].name == "fast");
+  CHECK(statistics[0].events + statistics[1].events == events.size());
+  CHECK(statistics[1].events >= 1);
+  CHECK(statistics[0].events > statistics[1].events);
+  CHECK(statistics[0].throughput > statistics[1].throughput);
+
+  CHECK_THROWS_AS(clue::EventScheduler<2>({}), std::invalid_argument);
+}
@@ -0,0 +1,199 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "same_clusters.hpp"
+
+// Returns the coordinates, in SoA format, and the weights of a range of rows of the points
+std::pair<std::vector<float>, std::vector<float>> rows(const clue::PointsHost<2>& points,
+                                                       std::size_t first,
+                                                       std::size_t n_rows) {
+  std::vector<float> coordinates(2 * n_rows), weights(n_rows);
+  for (auto i = 0u; i < n_rows; ++i) {
+    coordinates[i] = points.coords(0)[first + i];
+    coordinates[n_rows + i] = points.coords(1)[first + i];
+    weights[i] = points.weights()[first + i];
+  }
+  return {coordinates, weights};
+}
+
+// Clusters from scratch the rows of the points, listed in the order of the slots of the
+// incremental clusterer, and checks that the incremental labels describe the same clusters
+template <typename TIncremental>
+bool same_as_reclustering(clue::Queue& queue,
+                          const clue::PointsHost<2>& points,
+                          const std::vector<std::pair<int32_t, std::size_t>>& inserted,
+                          const TIncremental& incremental,
+                          float dc,
+                          float rhoc,
+                          float outlier,
+                          float seeding) {
+  const auto n_points = inserted.size();
+  if (incremental.points().size() != n_points)
+    return false;
+  std::unordered_map<int32_t, std::size_t> row_of;
+  for (const auto [index, row] : inserted)
+    row_of[index] = row;
+
+  std::vector<float> coordinates(2 * n_points), weights(n_points);
+  std::vector<int> labels(n_points), incremental_labels(n_points);
+  for (auto i = 0u; i < n_points; ++i) {
+    const auto index = incremental.points()[i];
+    const auto row = row_of.at(index);
+    coordinates[i] = points.coords(0)[row];
+    coordinates[n_points + i] = points.coords(1)[row];
+    weights[i] = points.weights()[row];
+    incremental_labels[i] = incremental.cluster_index(index);
+  }
+  clue::PointsHost<2> h_points(
+      queue, static_cast<int32_t>(n_points), coordinates.data(), weights.data(), labels.data());
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier, seeding);
+  algo.make_clusters(queue, h_points);
+  return test::same_clusters(labels, incremental_labels) &&
+         static_cast<std::size_t>(h_points.n_clusters()) == incremental.n_clusters();
+}
+
+TEST_CASE("Test incremental clustering against a full reclustering") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::IncrementalClusterer<2> incremental(queue, dc, rhoc, outlier);
+
+  // the indexes of the current points with their rows, in insertion order
+  std::vector<std::pair<int32_t, std::size_t>> inserted;
+  const std::size_t batch = 1000;
+  for (auto first = 0u; first < 6000; first += batch) {
+    const auto [coordinates, weights] = rows(h_points, first, batch);
+    const auto indexes = incremental.insert(queue, coordinates, weights);
+    for (auto i = 0u; i < batch; ++i)
+      inserted.emplace_back(indexes[i], first + i);
+  }
+  CHECK(incremental.size() == 6000);
+  CHECK(incremental.n_clusters() > 1);
+  CHECK(same_as_reclustering(queue, h_points, inserted, incremental, dc, rhoc, outlier, dc));
+
+  SUBCASE("Remove a scattered subset of the points") {
+    std::vector<int32_t> removed;
+    std::vector<std::pair<int32_t, std::size_t>> kept;
+    for (auto i = 0u; i < inserted.size(); ++i) {
+      if (i % 7 == 3)
+        removed.push_back(inserted[i].first);
+      else
+        kept.push_back(inserted[i]);
+    }
+    incremental.remove(queue, removed);
+    CHECK(incremental.size() == kept.size());
+    CHECK_FALSE(incremental.contains(removed.front()));
+    CHECK(same_as_reclustering(queue, h_points, kept, incremental, dc, rhoc, outlier, dc));
+
+    // the new points reuse the indexes of the removed ones
+    const auto [coordinates, weights] = rows(h_points, 6000, 500);
+    const auto indexes = incremental.insert(queue, coordinates, weights);
+    for (auto i = 0u; i < indexes.size(); ++i)
+      kept.emplace_back(indexes[i], 6000 + i);
+    CHECK(same_as_reclustering(queue, h_points, kept, incremental, dc, rhoc, outlier, dc));
+  }
+  SUBCASE("Insert and remove points in the same update") {
+    const auto [coordinates, weights] = rows(h_points, 6000, 200);
+    std::vector<int32_t> removed;
+    for (auto i = 0u; i < 200; ++i)
+      removed.push_back(inserted[i].first);
+    const auto indexes = incremental.update(queue, removed, coordinates, weights);
+
+    std::vector<std::pair<int32_t, std::size_t>> kept(inserted.begin() + 200, inserted.end());
+    for (auto i = 0u; i < indexes.size(); ++i)
+      kept.emplace_back(indexes[i], 6000 + i);
+    CHECK(incremental.size() == 6000);
+    CHECK(same_as_reclustering(queue, h_points, kept, incremental, dc, rhoc, outlier, dc));
+  }
+  SUBCASE("Remove and insert back the same points") {
+    // the points take back their slots, so none of them is rebinned in the tiles
+    std::unordered_map<int32_t, std::size_t> row_of(inserted.begin(), inserted.end());
+    const std::vector<int32_t> removed(incremental.points().begin(),
+                                       incremental.points().begin() + 200);
+    std::vector<float> coordinates(2 * 200), weights(200);
+    for (auto i = 0u; i < 200; ++i) {
+      const auto row = row_of.at(removed[i]);
+      coordinates[i] = h_points.coords(0)[row];
+      coordinates[200 + i] = h_points.coords(1)[row];
+      weights[i] = h_points.weights()[row];
+    }
+    const auto indexes = incremental.update(queue, removed, coordinates, weights);
+    CHECK(incremental.updated_points() == 0);
+
+    std::vector<std::pair<int32_t, std::size_t>> kept;
+    for (const auto& point : inserted) {
+      if (std::ranges::find(removed, point.first) == removed.end())
+        kept.push_back(point);
+    }
+    for (auto i = 0u; i < indexes.size(); ++i)
+      kept.emplace_back(indexes[i], row_of.at(removed[i]));
+    CHECK(same_as_reclustering(queue, h_points, kept, incremental, dc, rhoc, outlier, dc));
+  }
+}
+
+TEST_CASE("Test clustering a sliding window") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  const float dc{1.3f}, rhoc{10.f}, outlier{2.1f}, seeding{0.9f};
+  clue::IncrementalClusterer<2> incremental(queue, dc, rhoc, outlier, seeding);
+  clue::SlidingWindow<2> window(incremental, 4000);
+
+  std::vector<std::pair<int32_t, std::size_t>> inserted;
+  const std::size_t batch = 250;
+  for (auto first = 0u; first < 10000; first += batch) {
+    const auto [coordinates, weights] = rows(h_points, first, batch);
+    const auto indexes = window.push(queue, coordinates, weights);
+    for (auto i = 0u; i < batch; ++i)
+      inserted.emplace_back(indexes[i], first + i);
+    CHECK(window.size() == std::min<std::size_t>(first + batch, 4000));
+  }
+  CHECK(incremental.size() == 4000);
+  CHECK(window.points().front() == inserted[6000].first);
+
+  const std::vector<std::pair<int32_t, std::size_t>> current(inserted.begin() + 6000,
+                                                             inserted.end());
+  CHECK(same_as_reclustering(queue, h_points, current, incremental, dc, rhoc, outlier, seeding));
+
+  window.evict(queue, 1000);
+  CHECK(window.size() == 3000);
+  const std::vector<std::pair<int32_t, std::size_t>> evicted(inserted.begin() + 7000,
+                                                             inserted.end());
+  CHECK(same_as_reclustering(queue, h_points, evicted, incremental, dc, rhoc, outlier, seeding));
+}
+
+TEST_CASE("Test IncrementalClusterer throwing conditions") {
+  auto queue = clue::get_queue(0u);
+  CHECK_THROWS_AS(clue::IncrementalClusterer<2>(queue, -1.f, 10.f), std::invalid_argument);
+
+  clue::IncrementalClusterer<2> incremental(queue, 1.f, 10.f);
+  const std::vector<float> coordinates{0.f, 1.f, 0.f, 1.f};
+  const std::vector<float> weights{1.f, 1.f};
+  CHECK_THROWS_AS(incremental.insert(queue, coordinates, std::vector<float>{1.f}),
+                  std::invalid_argument);
+  const auto indexes = incremental.insert(queue, coordinates, weights);
+  CHECK_THROWS_AS(incremental.remove(queue, std::vector<int32_t>{indexes[0], indexes[0]}),
+                  std::invalid_argument);
+  CHECK_THROWS_AS(incremental.remove(queue, std::vector<int32_t>{42}), std::invalid_argument);
+  CHECK(incremental.size() == 2);
+  CHECK_THROWS_AS(incremental.cluster_index(42), std::invalid_argument);
+
+  CHECK_THROWS_AS(clue::SlidingWindow<2>(incremental, 10), std::invalid_argument);
+  clue::IncrementalClusterer<2> empty(queue, 1.f, 10.f);
+  CHECK_THROWS_AS(clue::SlidingWindow<2>(empty, 0), std::invalid_argument);
+}
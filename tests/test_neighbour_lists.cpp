@@ -0,0 +1,118 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+// Clusters a copy of the points with the tiles and returns the cluster indexes
+std::vector<int> cluster_with_tiles(clue::Queue& queue,
+                                    const clue::PointsHost<2>& points,
+                                    float dc,
+                                    float rhoc,
+                                    float outlier) {
+  const auto n_points = points.size();
+  std::vector<float> coordinates(2 * n_points), weights(n_points);
+  std::vector<int> labels(n_points);
+  for (auto i = 0; i < n_points; ++i) {
+    coordinates[i] = points.coords(0)[i];
+    coordinates[n_points + i] = points.coords(1)[i];
+    weights[i] = points.weights()[i];
+  }
+  clue::PointsHost<2> h_points(queue, n_points, coordinates.data(), weights.data(), labels.data());
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points);
+  return labels;
+}
+
+std::vector<int> labels(const clue::PointsHost<2>& points) {
+  return {points.clusterIndexes().begin(), points.clusterIndexes().end()};
+}
+
+TEST_CASE("Test clustering with neighbour lists") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_4096.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsDevice<2> d_points(queue, h_points.size());
+
+  SUBCASE("Outlier distance equal to the density radius") {
+    clue::Clusterer<2> algo(queue, 1.3f, 10.f, 1.3f);
+    algo.setNeighbourLists(true);
+    algo.make_clusters(queue, h_points, d_points);
+    CHECK(h_points.n_clusters() > 1);
+    CHECK(labels(h_points) == cluster_with_tiles(queue, h_points, 1.3f, 10.f, 1.3f));
+  }
+  SUBCASE("Outlier distance larger than the density radius, with sorted tiles") {
+    clue::Clusterer<2> algo(queue, 1.3f, 10.f, 2.f);
+    algo.setNeighbourLists(true);
+    algo.setSortedTiles(true);
+    algo.make_clusters(queue, h_points, d_points);
+    CHECK(labels(h_points) == cluster_with_tiles(queue, h_points, 1.3f, 10.f, 2.f));
+  }
+}
+
+TEST_CASE("Test sweeping the parameters over the neighbour lists") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_4096.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsDevice<2> d_points(queue, h_points.size());
+
+  // the lists of the largest outlier distance of the sweep take about 4 MiB
+  clue::Clusterer<2> algo(queue, 1.5f, 10.f, 2.f);
+  algo.setNeighbourLists(true);
+  // without a previous run the points are clustered from scratch
+  CHECK_FALSE(algo.recluster(queue, h_points, d_points));
+
+  for (const auto rhoc : {5.f, 10.f, 20.f}) {
+    algo.setParameters(1.3f, rhoc, 1.8f);
+    CHECK(algo.recluster(queue, h_points, d_points));
+    CHECK(labels(h_points) == cluster_with_tiles(queue, h_points, 1.3f, rhoc, 1.8f));
+  }
+
+  // the lists don't hold the neighbours farther than the distances with which they were built
+  algo.setParameters(1.3f, 10.f, 2.5f);
+  CHECK_FALSE(algo.recluster(queue, h_points, d_points));
+  CHECK(labels(h_points) == cluster_with_tiles(queue, h_points, 1.3f, 10.f, 2.5f));
+  // the lists built in the fallback run are reused by the following ones
+  algo.setParameters(1.3f, 10.f, 1.3f);
+  CHECK(algo.recluster(queue, d_points));
+  clue::copyToHost(queue, h_points, d_points);
+  CHECK(labels(h_points) == cluster_with_tiles(queue, h_points, 1.3f, 10.f, 1.3f));
+
+  // the lists aren't reused for other points of the same size, even if already clustered
+  std::vector<float> coordinates(2 * h_points.size()), weights(h_points.size());
+  std::vector<int> other_labels(h_points.size());
+  for (auto i = 0; i < h_points.size(); ++i) {
+    coordinates[i] = 1.1f * h_points.coords(0)[i];
+    coordinates[h_points.size() + i] = 1.1f * h_points.coords(1)[i];
+    weights[i] = h_points.weights()[i];
+  }
+  clue::PointsHost<2> h_other(
+      queue, h_points.size(), coordinates.data(), weights.data(), other_labels.data());
+  clue::PointsDevice<2> d_other(queue, h_points.size());
+  clue::Clusterer<2>(queue, 1.3f, 10.f, 1.3f).make_clusters(queue, h_other, d_other);
+  CHECK_FALSE(algo.recluster(queue, h_other, d_other));
+  CHECK(other_labels == cluster_with_tiles(queue, h_other, 1.3f, 10.f, 1.3f));
+}
+
+TEST_CASE("Test falling back to the tiles above the memory cap") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_4096.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsDevice<2> d_points(queue, h_points.size());
+
+  clue::Clusterer<2> algo(queue, 1.3f, 10.f, 2.f);
+  algo.setNeighbourLists(true, 1024);
+  algo.make_clusters(queue, h_points, d_points);
+  CHECK(labels(h_points) == cluster_with_tiles(queue, h_points, 1.3f, 10.f, 2.f));
+  CHECK_FALSE(algo.recluster(queue, h_points, d_points));
+
+  clue::PointsDevice<2> smaller_points(queue, h_points.size() - 1);
+  CHECK_THROWS_AS(algo.recluster(queue, h_points, smaller_points), std::invalid_argument);
+}
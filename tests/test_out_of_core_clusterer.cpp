@@ -0,0 +1,103 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "same_clusters.hpp"
+
+// Returns a path in the temporary directory with a suffix drawn once per process, so that test
+// runs executing at the same time don't share their files
+std::filesystem::path temp_path(const std::string& name) {
+  static const auto suffix = std::to_string(std::random_device{}());
+  return std::filesystem::temp_directory_path() / (name + "_" + suffix + ".bin");
+}
+
+template <std::size_t Ndim>
+std::string write_points(const clue::PointsHost<Ndim>& points, const std::string& name) {
+  const auto path = temp_path(name).string();
+  std::ofstream file(path, std::ios::binary);
+  for (auto i = 0; i < points.size(); ++i) {
+    for (auto dim = 0u; dim < Ndim; ++dim)
+      file.write(reinterpret_cast<const char*>(&points.coords(dim)[i]), sizeof(float));
+    file.write(reinterpret_cast<const char*>(&points.weights()[i]), sizeof(float));
+  }
+  return path;
+}
+
+std::vector<int> read_labels(const std::string& path) {
+  std::vector<int> labels(std::filesystem::file_size(path) / sizeof(int32_t));
+  std::ifstream file(path, std::ios::binary);
+  file.read(reinterpret_cast<char*>(labels.data()), labels.size() * sizeof(int32_t));
+  return labels;
+}
+
+TEST_CASE("Test out-of-core clustering against a single clusterer") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points);
+
+  const auto input = write_points(h_points, "clue_out_of_core_input");
+  const auto output = temp_path("clue_out_of_core_labels");
+
+  SUBCASE("Cluster with a single buffer") {
+    clue::OutOfCoreClusterer<2> ooc(8000, 1, dc, rhoc, outlier);
+    const auto n_clusters = ooc.make_clusters(input, output.string());
+
+    CHECK(ooc.n_chunks() > 1);
+    CHECK(n_clusters == h_points.n_clusters());
+    CHECK(test::same_clusters(h_points.clusterIndexes(), read_labels(output.string())));
+  }
+  SUBCASE("Cluster with several buffers and coarse bins") {
+    clue::OutOfCoreClusterer<2> ooc(12000, 3, dc, rhoc, outlier);
+    ooc.setHistogramBins(512);
+    const auto n_clusters = ooc.make_clusters(input, output.string());
+
+    CHECK(ooc.n_chunks() > 2);
+    CHECK(n_clusters == h_points.n_clusters());
+    CHECK(test::same_clusters(h_points.clusterIndexes(), read_labels(output.string())));
+  }
+  SUBCASE("Cluster in a single chunk") {
+    clue::OutOfCoreClusterer<2> ooc(h_points.size(), 1, dc, rhoc, outlier);
+    ooc.make_clusters(input, output.string());
+
+    CHECK(ooc.n_chunks() == 1);
+    CHECK(test::same_clusters(h_points.clusterIndexes(), read_labels(output.string())));
+  }
+  SUBCASE("Chunks too small for the halo") {
+    clue::OutOfCoreClusterer<2> ooc(10, 1, dc, rhoc, outlier);
+    CHECK_THROWS_AS(ooc.make_clusters(input, output.string()), std::runtime_error);
+  }
+
+  std::filesystem::remove(input);
+  std::filesystem::remove(output);
+}
+
+TEST_CASE("Test OutOfCoreClusterer throwing conditions") {
+  CHECK_THROWS_AS(clue::OutOfCoreClusterer<2>(0, 1, 1.f, 10.f), std::invalid_argument);
+  CHECK_THROWS_AS(clue::OutOfCoreClusterer<2>(100, 0, 1.f, 10.f), std::invalid_argument);
+
+  clue::OutOfCoreClusterer<2> ooc(100, 1, 1.f, 10.f);
+  CHECK_THROWS_AS(ooc.setHistogramBins(0), std::invalid_argument);
+
+  const auto input = temp_path("clue_out_of_core_truncated").string();
+  const auto unused = temp_path("clue_out_of_core_unused").string();
+  std::ofstream(input, std::ios::binary) << "abcde";
+  CHECK_THROWS_AS(ooc.make_clusters(input, unused), std::invalid_argument);
+  CHECK_THROWS_AS(ooc.make_clusters(temp_path("clue_missing").string(), unused),
+                  std::runtime_error);
+  std::filesystem::remove(input);
+}
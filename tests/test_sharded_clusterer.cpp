@@ -0,0 +1,59 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "same_clusters.hpp"
+
+TEST_CASE("Test sharded clustering against a single clusterer") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<2> algo(queue, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points);
+
+  for (auto n_shards : {1u, 2u, 3u, 5u}) {
+    clue::PointsHost<2> h_sharded = clue::read_csv<2, float>(queue, test_file_path);
+    clue::ShardedClusterer<2> sharded(n_shards, dc, rhoc, outlier);
+    CHECK(sharded.size() == n_shards);
+    CHECK(sharded.halo_width() == doctest::Approx(2 * dc));
+    sharded.make_clusters(h_sharded);
+
+    CHECK(test::same_clusters(h_points.clusterIndexes(), h_sharded.clusterIndexes()));
+    CHECK(h_sharded.n_clusters() == h_points.n_clusters());
+  }
+}
+
+TEST_CASE("Test sharded clustering with several queues on the same device") {
+  const auto device = clue::get_device(0u);
+  const std::vector<clue::Device> devices(4, device);
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_dim_3.csv";
+  clue::PointsHost<3> h_points = clue::read_csv<3, float>(queue, test_file_path);
+  const float dc{1.3f}, rhoc{10.f}, outlier{1.3f};
+  clue::Clusterer<3> algo(queue, dc, rhoc, outlier);
+  algo.make_clusters(queue, h_points);
+
+  clue::PointsHost<3> h_sharded = clue::read_csv<3, float>(queue, test_file_path);
+  clue::ShardedClusterer<3> sharded(devices, 4, dc, rhoc, outlier);
+  sharded.make_clusters(h_sharded);
+
+  CHECK(h_points.n_clusters() > 1);
+  CHECK(test::same_clusters(h_points.clusterIndexes(), h_sharded.clusterIndexes()));
+}
+
+TEST_CASE("Test ShardedClusterer constructor throwing conditions") {
+  CHECK_THROWS_AS(clue::ShardedClusterer<2>(0, 1.f, 10.f), std::invalid_argument);
+  CHECK_THROWS_AS(clue::ShardedClusterer<2>(std::span<const clue::Device>{}, 2, 1.f, 10.f),
+                  std::invalid_argument);
+  CHECK_THROWS(clue::ShardedClusterer<2>(2, -1.f, 10.f));
+}
@@ -0,0 +1,103 @@
+
+#include "CLUEstering/CLUEstering.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+// Clusters from scratch a copy of the points and returns the cluster indexes
+std::vector<int> recluster(clue::Queue& queue,
+                           std::vector<float> coordinates,
+                           std::vector<float> weights,
+                           bool separate_tiles) {
+  const auto n_points = static_cast<int32_t>(weights.size());
+  std::vector<int> labels(n_points);
+  clue::PointsHost<2> h_points(queue, n_points, coordinates.data(), weights.data(), labels.data());
+  clue::Clusterer<2> algo(queue, 1.3f, 10.f, 1.3f);
+  algo.setSeparateNearestHigherTiles(separate_tiles);
+  algo.make_clusters(queue, h_points);
+  return labels;
+}
+
+// Moves the points of a dataset in several steps, checking after each update that the clusters
+// are the ones found clustering the points from scratch
+void test_moving_points(bool separate_tiles) {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  const clue::PointsHost<2> input = clue::read_csv<2, float>(queue, test_file_path);
+  const auto n_points = input.size();
+  std::vector<float> coordinates(2 * n_points), weights(n_points);
+  for (auto i = 0; i < n_points; ++i) {
+    coordinates[i] = input.coords(0)[i];
+    coordinates[n_points + i] = input.coords(1)[i];
+    weights[i] = input.weights()[i];
+  }
+  std::vector<int> labels(n_points);
+  clue::PointsHost<2> h_points(queue, n_points, coordinates.data(), weights.data(), labels.data());
+  clue::PointsDevice<2> d_points(queue, n_points);
+
+  clue::Clusterer<2> algo(queue, 1.3f, 10.f, 1.3f);
+  algo.setSeparateNearestHigherTiles(separate_tiles);
+  algo.make_clusters(queue, h_points, d_points);
+
+  // the points are moved slightly, without leaving the region covered by the tiles
+  std::mt19937 engine(42);
+  std::uniform_real_distribution<float> jitter(-.05f, .05f);
+  for (auto dim = 0; dim < 2; ++dim) {
+    const auto first = coordinates.begin() + dim * n_points;
+    const auto [min, max] = std::minmax_element(first, first + n_points);
+    const auto low = *min, high = *max;
+    std::for_each(
+        first, first + n_points, [&](float& x) { x = std::clamp(x + jitter(engine), low, high); });
+  }
+  auto n_moved = algo.update_positions(queue, h_points, d_points);
+  CHECK(n_moved > 0);
+  CHECK(n_moved < static_cast<std::size_t>(n_points));
+  CHECK(labels == recluster(queue, coordinates, weights, separate_tiles));
+
+  // the first and the last hundred points swap their positions and are updated on the device
+  for (auto dim = 0; dim < 2; ++dim) {
+    const auto first = coordinates.begin() + dim * n_points;
+    std::swap_ranges(first, first + 100, first + n_points - 100);
+  }
+  std::swap_ranges(weights.begin(), weights.begin() + 100, weights.end() - 100);
+  clue::copyToDevice(queue, d_points, h_points);
+  n_moved = algo.update_positions(queue, d_points);
+  CHECK(n_moved > 0);
+  CHECK(n_moved <= 200);
+  clue::copyToHost(queue, h_points, d_points);
+  CHECK(labels == recluster(queue, coordinates, weights, separate_tiles));
+
+  // the points leave the region covered by the tiles, which are then rebuilt
+  std::ranges::transform(coordinates, coordinates.begin(), [](float x) { return 3.f * x; });
+  n_moved = algo.update_positions(queue, h_points, d_points);
+  CHECK(n_moved == static_cast<std::size_t>(n_points));
+  CHECK(labels == recluster(queue, coordinates, weights, separate_tiles));
+}
+
+TEST_CASE("Test updating the clusters of moving points") {
+  SUBCASE("Shared tiles") { test_moving_points(false); }
+  SUBCASE("Separate nearest-higher tiles") { test_moving_points(true); }
+}
+
+TEST_CASE("Test updating the clusters of points not clustered before") {
+  auto queue = clue::get_queue(0u);
+
+  const auto test_file_path = std::string(TEST_DATA_DIR) + "/data_32768.csv";
+  clue::PointsHost<2> h_points = clue::read_csv<2, float>(queue, test_file_path);
+  clue::PointsDevice<2> d_points(queue, h_points.size());
+  clue::Clusterer<2> algo(queue, 1.3f, 10.f, 1.3f);
+
+  clue::PointsDevice<2> smaller_points(queue, h_points.size() - 1);
+  CHECK_THROWS_AS(algo.update_positions(queue, h_points, smaller_points), std::invalid_argument);
+  // without a previous run the points are clustered from scratch
+  CHECK(algo.update_positions(queue, h_points, d_points) ==
+        static_cast<std::size_t>(h_points.size()));
+  CHECK(h_points.n_clusters() > 1);
+}